@@ -74,7 +74,7 @@ int luaopen_Qt5Core_QCoreApplication(lua_State* const state)
 
     env["QCoreApplication"] = lua::value::table;
     env["QCoreApplication"]["new"] = lua::QCoreApplication_new<QCoreApplication>;
-    auto t = env["QCoreApplication"];
+    lua::pinned t(env["QCoreApplication"]);
 
     t["addLibraryPath"] = &QCoreApplication::addLibraryPath;
     t["applicationDirPath"] = &QCoreApplication::applicationDirPath;
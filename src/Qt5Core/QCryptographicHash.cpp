@@ -42,7 +42,7 @@ int luaopen_Qt5Core_QCryptographicHash(lua_State* const state)
     env["QCryptographicHash"] = lua::value::table;
     env["QCryptographicHash"]["new"] = QCryptographicHash_new;
     env["QCryptographicHash"]["hash"] = &QCryptographicHash::hash;
-    auto t = env["QCryptographicHash"];
+    lua::pinned t(env["QCryptographicHash"]);
 
     // enum QCryptographicHash::Algorithm
     t["Md4"] = QCryptographicHash::Md4;
@@ -6,16 +6,16 @@
 
 bool lua::QEventFilter::eventFilter(QObject* watched, QEvent* event)
 {
-    if (!_target.type().function()) {
+    if (!_target) {
         return false;
     }
-    return lua::call<bool>(_target, watched, event);
+    return _target(watched, event);
 }
 
 void lua::QEventFilter::setDelegate(const lua::index& delegate)
 {
     lua::assert_type("QEventFilter:setDelegate", lua::type::function, delegate);
-    _target = delegate;
+    _target.set(delegate);
 }
 
 int QEventFilter_setDelegate(lua_State* const state)
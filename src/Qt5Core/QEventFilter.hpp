@@ -34,8 +34,7 @@
 */
 
 #include "../stack.hpp"
-#include "../reference.hpp"
-#include "../algorithm.hpp"
+#include "../function.hpp"
 
 #include <QObject>
 
@@ -44,7 +43,7 @@ namespace lua {
 class QEventFilter : public QObject
 {
 
-lua::reference _target;
+lua::function<bool(QObject*, QEvent*)> _target;
 
 public:
 
@@ -56,8 +55,7 @@ Creates a new filter with the given delegate, if one is given.
 
 */
 
-QEventFilter(lua_State* const state) :
-    _target(state)
+QEventFilter(lua_State* const state)
 {
 }
 
@@ -0,0 +1,58 @@
+#ifndef LUACXX_QFLAGS_INCLUDED
+#define LUACXX_QFLAGS_INCLUDED
+
+#include "../stack.hpp"
+#include "../overload.hpp"
+
+#include <QFlags>
+
+#include <sstream>
+
+// http://qt-project.org/doc/qt-5/qflags.html
+//
+// Flags can be given as a single enum value, like Qt.AutoColor, as a number,
+// or as a flags userdata returned from a binding. Anything else is refused,
+// rather than read as no flags.
+
+namespace lua {
+
+template <class Enum>
+struct Store<QFlags<Enum>>
+{
+    static void store(QFlags<Enum>& destination, const lua::index& source)
+    {
+        if (source.type().number()) {
+            destination = QFlags<Enum>(QFlag(static_cast<int>(lua_tointeger(source.state(), source.pos()))));
+            return;
+        }
+        if (lua::is_type<Enum>(source)) {
+            destination = lua::get<Enum>(source);
+            return;
+        }
+        if (lua::is_type<QFlags<Enum>>(source)) {
+            store_userdata<lua::userdata_storage::value>(destination, source);
+            return;
+        }
+
+        std::stringstream str;
+        str << "lua::Store<QFlags>::store: Flags must be given as an enum value, a number, or flags, but a "
+            << source.type().name() << " was given";
+        throw lua::error(str.str());
+    }
+};
+
+// Flags have several forms, so the overload accepts any value and leaves the
+// check to Store, which raises an error rather than letting the overload fall
+// back to a candidate without the flags.
+template <class Enum>
+struct Parameter<QFlags<Enum>>
+{
+    static lua::parameter_type get()
+    {
+        return lua::parameter_type();
+    }
+};
+
+} // namespace lua
+
+#endif // LUACXX_QFLAGS_INCLUDED
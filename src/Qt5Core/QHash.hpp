@@ -0,0 +1,39 @@
+#ifndef LUACXX_QHASH_INCLUDED
+#define LUACXX_QHASH_INCLUDED
+
+#include "../stack.hpp"
+#include "../convert/map.hpp"
+
+#include <QHash>
+
+// http://qt-project.org/doc/qt-5/qhash.html
+//
+// QHash values are pushed as new tables, and tables are stored by setting each
+// of their keys in the QHash, using the same conversions as std::map.
+
+namespace lua {
+
+template <class K, class V>
+struct Push<QHash<K, V>>
+{
+    static void push(lua_State* const state, const QHash<K, V>& source)
+    {
+        lua::table_builder table(state, 0, source.size());
+        for (auto i = source.constBegin(); i != source.constEnd(); ++i) {
+            table.set(i.key(), i.value());
+        }
+    }
+};
+
+template <class K, class V>
+struct Store<QHash<K, V>>
+{
+    static void store(QHash<K, V>& destination, const lua::index& source)
+    {
+        lua::store_map(destination, source);
+    }
+};
+
+}; // namespace lua
+
+#endif // LUACXX_QHASH_INCLUDED
@@ -2,27 +2,106 @@
 #define LUACXX_QLIST_INCLUDED
 
 #include "../stack.hpp"
-/*
+#include "../convert/callable.hpp"
+#include "../sequence_view.hpp"
+
+#include <QList>
+
+// http://qt-project.org/doc/qt-5/qlist.html
+//
+// Only methods that work for any element type are bound, so lists of types
+// without operator== can still be pushed. view() returns a
+// lua::sequence_view, which Lua can index in place.
+
+template <class T>
+int QList_at(lua_State* const state)
+{
+    auto self = lua::get<QList<T>*>(state, 1);
+    auto i = lua::get<int>(state, 2);
+    if (i < 0 || i >= self->size()) {
+        throw lua::error("QList.at: Index out of range");
+    }
+    lua::push(state, self->at(i));
+    return 1;
+}
+
+template <class T>
+int QList_first(lua_State* const state)
+{
+    auto self = lua::get<QList<T>*>(state, 1);
+    if (self->isEmpty()) {
+        throw lua::error("QList.first: The list must not be empty");
+    }
+    lua::push(state, self->first());
+    return 1;
+}
+
+template <class T>
+int QList_last(lua_State* const state)
+{
+    auto self = lua::get<QList<T>*>(state, 1);
+    if (self->isEmpty()) {
+        throw lua::error("QList.last: The list must not be empty");
+    }
+    lua::push(state, self->last());
+    return 1;
+}
+
+// The view keeps the list's userdata alive.
+template <class T>
+int QList_view(lua_State* const state)
+{
+    lua::push_view(state, lua::get<QList<T>*>(state, 1), 1);
+    return 1;
+}
+
+template <class T>
+void QList_append(QList<T>& self, const T value)
+{
+    self.append(value);
+}
+
+template <class T>
+void QList_insert(QList<T>& self, const int i, const T value)
+{
+    self.insert(i, value);
+}
 
 namespace lua {
 
-void QList_metatable(const lua::index& mt);
+template <class T>
+void QList_metatable(const lua::index& mt)
+{
+    mt["append"] = &QList_append<T>;
+    mt["at"] = &QList_at<T>;
+    mt["clear"] = &QList<T>::clear;
+    mt["first"] = &QList_first<T>;
+    mt["insert"] = &QList_insert<T>;
+    mt["isEmpty"] = &QList<T>::isEmpty;
+    mt["last"] = &QList_last<T>;
+    mt["length"] = &QList<T>::length;
+    mt["move"] = &QList<T>::move;
+    mt["removeAt"] = &QList<T>::removeAt;
+    mt["removeFirst"] = &QList<T>::removeFirst;
+    mt["removeLast"] = &QList<T>::removeLast;
+    mt["size"] = &QList<T>::size;
+    mt["view"] = &QList_view<T>;
+}
 
-template <>
-struct Metatable<QList>
+template <class T>
+struct Metatable<QList<T>>
 {
     static constexpr const char* name = "QList";
 
-    static bool metatable(const lua::index& mt, QList* const)
+    static bool metatable(const lua::index& mt, QList<T>* const)
     {
-        lua::QList_metatable(mt);
+        lua::QList_metatable<T>(mt);
         return true;
     }
 };
 
 }; // namespace lua
 
-extern "C" int luaopen_Qt5Core_QList(lua_State* const);
-*/
+LUACXX_SEQUENCE_VIEW_NAMES(QList)
 
 #endif // LUACXX_QLIST_INCLUDED
@@ -150,7 +150,7 @@ int luaopen_Qt5Core_QLocale(lua_State* const state)
 
     env["QLocale"] = lua::value::table;
     env["QLocale"]["new"] = QLocale_new;
-    auto t = env["QLocale"];
+    lua::pinned t(env["QLocale"]);
 
     t["c"] = &QLocale::c;
     t["countryToString"] = &QLocale::countryToString;
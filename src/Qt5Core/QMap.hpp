@@ -0,0 +1,39 @@
+#ifndef LUACXX_QMAP_INCLUDED
+#define LUACXX_QMAP_INCLUDED
+
+#include "../stack.hpp"
+#include "../convert/map.hpp"
+
+#include <QMap>
+
+// http://qt-project.org/doc/qt-5/qmap.html
+//
+// QMap values are pushed as new tables, and tables are stored by setting each
+// of their keys in the QMap, using the same conversions as std::map.
+
+namespace lua {
+
+template <class K, class V>
+struct Push<QMap<K, V>>
+{
+    static void push(lua_State* const state, const QMap<K, V>& source)
+    {
+        lua::table_builder table(state, 0, source.size());
+        for (auto i = source.constBegin(); i != source.constEnd(); ++i) {
+            table.set(i.key(), i.value());
+        }
+    }
+};
+
+template <class K, class V>
+struct Store<QMap<K, V>>
+{
+    static void store(QMap<K, V>& destination, const lua::index& source)
+    {
+        lua::store_map(destination, source);
+    }
+};
+
+}; // namespace lua
+
+#endif // LUACXX_QMAP_INCLUDED
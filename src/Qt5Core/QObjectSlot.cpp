@@ -16,6 +16,7 @@ lua::QObjectSlot::QObjectSlot(QObject* const parent, const QMetaMethod& signal,
 int lua::QObjectSlot::qt_metacall(QMetaObject::Call call, int id, void **arguments)
 {
     auto state = _slot.state();
+    auto handler = lua::push_error_handler(state);
     auto callable = lua::push(state, _slot);
 
     QList<QByteArray> params = _signal.parameterTypes();
@@ -31,6 +32,7 @@ int lua::QObjectSlot::qt_metacall(QMetaObject::Call call, int id, void **argumen
     } catch (lua::error& ex) {
         std::cerr << "lua::QObjectSlot::qt_metacall: Error caught during slot invocation: " << ex.what() << std::endl;
     }
+    lua_settop(state, handler.pos() - 1);
 
     return -1;
 }
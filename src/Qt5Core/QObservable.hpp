@@ -2,8 +2,7 @@
 #define LUACXX_QOBSERVABLE_INCLUDED
 
 #include "../stack.hpp"
-#include "../reference.hpp"
-#include "../algorithm.hpp"
+#include "../function.hpp"
 #include "../convert/string.hpp"
 #include "QEvent.hpp"
 #include <iostream>
@@ -14,19 +13,18 @@ template <class Object>
 class QObservable : public Object
 {
 
-lua::reference _target;
+lua::function<bool(QEvent*)> _target;
 
 public:
     template <class... Args>
     QObservable(lua_State* const state, Args... args) :
-        Object(args...),
-        _target(state)
+        Object(args...)
     {
     }
 
     bool event(QEvent* event) override
     {
-        if (_target && lua::call<bool>(_target, event)) {
+        if (_target && _target(event)) {
             return true;
         } else {
             return Object::event(event);
@@ -35,7 +33,7 @@ public:
 
     void setDelegate(const lua::index& delegate)
     {
-        _target = delegate;
+        _target.set(delegate);
     }
 };
 
@@ -2,6 +2,7 @@
 #define LUACXX_TYPE_QSTRING_INCLUDED
 
 #include "../convert/string.hpp"
+#include "../overload.hpp"
 
 #include <QString>
 
@@ -25,6 +26,24 @@ struct Store<QString>
     }
 };
 
+template <>
+struct Get<const QString&>
+{
+    static QString get(const lua::index& source)
+    {
+        return lua::Get<QString>::get(source);
+    }
+};
+
+template <>
+struct Parameter<QString>
+{
+    static lua::parameter_type get()
+    {
+        return lua::parameter_type(LUA_TSTRING, nullptr, lua::type_bit(LUA_TNUMBER));
+    }
+};
+
 } // namespace lua
 
 #endif // LUACXX_TYPE_QSTRING_INCLUDED
@@ -20,7 +20,7 @@ int luaopen_Qt5Core_QUrl(lua_State* const state)
 
     env["QUrl"] = lua::value::table;
     env["QUrl"]["new"] = QUrl_new;
-    auto t = env["QUrl"];
+    lua::pinned t(env["QUrl"]);
 
     return 0;
 }
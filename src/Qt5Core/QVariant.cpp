@@ -1,8 +1,11 @@
 #include "QVariant.hpp"
 
 #include "QChar.hpp"
+#include "QHash.hpp"
 #include "QString.hpp"
 #include "../algorithm.hpp"
+#include "../table_builder.hpp"
+#include "../table_view.hpp"
 #include "../convert/string.hpp"
 #include "../convert/numeric.hpp"
 
@@ -61,23 +64,15 @@ void lua::push_qvariant(lua_State* const state, const QVariant& value)
             lua::push(state, value.toString());
             break;
         case QVariant::Hash:
-        {
-            auto hash = value.toHash();
-
-            auto table = lua::push(state, lua::value::table);
-            for (auto i = hash.begin(); i != hash.end(); ++i) {
-                lua::table::set(table, i.key(), i.value());
-            }
-
+            lua::push(state, value.toHash());
             break;
-        }
         case QVariant::StringList:
         {
             auto list = value.toStringList();
 
-            auto table = lua::push(state, lua::value::table);
+            lua::table_builder table(state, list.size(), 0);
             for (int i = 0; i < list.size(); ++i) {
-                lua::table::set(table, i + 1, list[i]);
+                table.append(list[i]);
             }
 
             break;
@@ -119,15 +114,11 @@ void lua::store_qvariant(QVariant& destination, const lua::index& source)
             break;
         case QVariant::StringList:
         {
-            auto state = source.state();
+            lua::table_view<QString> view(source);
             QStringList items;
-
-            auto length = lua_rawlen(state, source.pos());
-            for (unsigned int i = 1; i <= length; ++i) {
-                lua::push(state, i);
-                lua_gettable(state, source.pos());
-                items << lua::get<QString>(state, -1);
-                lua_pop(state, 1);
+            items.reserve(view.size());
+            for (auto item : view) {
+                items << item;
             }
 
             destination.setValue(items);
@@ -136,17 +127,8 @@ void lua::store_qvariant(QVariant& destination, const lua::index& source)
         case QVariant::Hash:
         {
             QHash<QString, QVariant> hash;
-
-            auto state = source.state();
-
-            lua::push(state, lua::value::nil);
-            while (lua_next(state, source.pos()) != 0) {
-                auto key = lua::get<QString>(state, -2);
-                auto value = lua::get<QVariant>(state, -1);
-
-                hash[key] = value;
-
-                lua_pop(state, 1);
+            for (auto pair : lua::table_map_view<QString, QVariant>(source)) {
+                hash[pair.first] = pair.second;
             }
 
             destination.setValue(hash);
@@ -3,111 +3,170 @@
 
 #include "../stack.hpp"
 #include "../convert/callable.hpp"
+#include "../sequence_view.hpp"
 
+#include <QPoint>
+#include <QPointF>
 #include <QVector>
 
+#include <sstream>
+
 // http://qt-project.org/doc/qt-5/qvector.html
+//
+// Iterators and raw pointers have no Lua equivalent, so begin(), end(),
+// erase(), cbegin(), constBegin(), constData() and the like are omitted.
+// data() returns a lua::sequence_view, which Lua can index in place.
+
+// Throws unless the range from i to i + count fits within the given size, since
+// QVector only asserts its indices.
+inline void QVector_check_range(const char* const name, const int i, const int count, const int size)
+{
+    if (i < 0 || count < 0 || i > size - count) {
+        std::stringstream str;
+        str << "QVector." << name << ": Index " << i << " is out of range for a vector of size " << size;
+        throw lua::error(str.str());
+    }
+}
 
 template <class T>
-int QVector_back(lua_State* const state)
+int QVector_at(lua_State* const state)
 {
-    return 0;
+    auto self = lua::get<QVector<T>*>(state, 1);
+    auto i = lua::get<int>(state, 2);
+    QVector_check_range("at", i, 1, self->size());
+    lua::push(state, self->at(i));
+    return 1;
 }
 
 template <class T>
-int QVector_begin(lua_State* const state)
+int QVector_back(lua_State* const state)
 {
-    return 0;
+    auto self = lua::get<QVector<T>*>(state, 1);
+    if (self->isEmpty()) {
+        throw lua::error("QVector.back: The vector must not be empty");
+    }
+    lua::push(state, self->back());
+    return 1;
 }
 
 template <class T>
 int QVector_count(lua_State* const state)
 {
-    return 0;
+    auto self = lua::get<QVector<T>*>(state, 1);
+    if (lua_gettop(state) > 1) {
+        // int count(const T & value) const
+        lua::push(state, self->count(lua::get<T>(state, 2)));
+    } else {
+        // int count() const
+        lua::push(state, self->count());
+    }
+    return 1;
 }
 
+// Returns a lua::sequence_view of the vector, rather than a pointer. The view
+// keeps the vector's userdata alive.
 template <class T>
 int QVector_data(lua_State* const state)
 {
-    return 0;
-}
-
-template <class T>
-int QVector_end(lua_State* const state)
-{
-    return 0;
-}
-
-template <class T>
-int QVector_erase(lua_State* const state)
-{
-    return 0;
+    lua::push_view(state, lua::get<QVector<T>*>(state, 1), 1);
+    return 1;
 }
 
 template <class T>
 int QVector_first(lua_State* const state)
 {
-    return 0;
+    auto self = lua::get<QVector<T>*>(state, 1);
+    if (self->isEmpty()) {
+        throw lua::error("QVector.first: The vector must not be empty");
+    }
+    lua::push(state, self->first());
+    return 1;
 }
 
 template <class T>
 int QVector_front(lua_State* const state)
 {
-    return 0;
+    return QVector_first<T>(state);
 }
 
 template <class T>
 int QVector_insert(lua_State* const state)
 {
+    auto self = lua::get<QVector<T>*>(state, 1);
+    auto i = lua::get<int>(state, 2);
+    QVector_check_range("insert", i, 0, self->size());
+    if (lua_gettop(state) > 3) {
+        // void insert(int i, int count, const T & value)
+        auto count = lua::get<int>(state, 3);
+        if (count < 0) {
+            throw lua::error("QVector.insert: The count must not be negative");
+        }
+        self->insert(i, count, lua::get<T>(state, 4));
+    } else {
+        // void insert(int i, const T & value)
+        self->insert(i, lua::get<T>(state, 3));
+    }
     return 0;
 }
 
 template <class T>
 int QVector_last(lua_State* const state)
 {
-    return 0;
-}
-
-template <class T>
-int QVector_pop_back(lua_State* const state)
-{
-    return 0;
-}
-
-template <class T>
-int QVector_pop_front(lua_State* const state)
-{
-    return 0;
-}
-
-template <class T>
-int QVector_prepend(lua_State* const state)
-{
-    return 0;
+    auto self = lua::get<QVector<T>*>(state, 1);
+    if (self->isEmpty()) {
+        throw lua::error("QVector.last: The vector must not be empty");
+    }
+    lua::push(state, self->last());
+    return 1;
 }
 
 template <class T>
-int QVector_push_back(lua_State* const state)
+int QVector_remove(lua_State* const state)
 {
+    auto self = lua::get<QVector<T>*>(state, 1);
+    auto i = lua::get<int>(state, 2);
+    if (lua_gettop(state) > 2) {
+        // void remove(int i, int count)
+        auto count = lua::get<int>(state, 3);
+        QVector_check_range("remove", i, count, self->size());
+        self->remove(i, count);
+    } else {
+        // void remove(int i)
+        QVector_check_range("remove", i, 1, self->size());
+        self->remove(i);
+    }
     return 0;
 }
 
 template <class T>
-int QVector_push_front(lua_State* const state)
+void QVector_replace(QVector<T>& self, const int i, const T value)
 {
-    return 0;
+    QVector_check_range("replace", i, 1, self.size());
+    self.replace(i, value);
 }
 
 template <class T>
-int QVector_remove(lua_State* const state)
+T QVector_takeAt(QVector<T>& self, const int i)
 {
-    return 0;
+    QVector_check_range("takeAt", i, 1, self.size());
+    return self.takeAt(i);
 }
 
 template <class T>
 int QVector_value(lua_State* const state)
 {
-    return 0;
+    auto self = lua::get<QVector<T>*>(state, 1);
+    if (lua_gettop(state) > 2) {
+        // T value(int i, const T & defaultValue) const
+        lua::push(state, self->value(
+            lua::get<int>(state, 2),
+            lua::get<T>(state, 3)
+        ));
+    } else {
+        // T value(int i) const
+        lua::push(state, self->value(lua::get<int>(state, 2)));
+    }
+    return 1;
 }
 
 namespace lua {
@@ -116,23 +175,15 @@ template <class T>
 void QVector_metatable(const lua::index& mt)
 {
     mt["append"] = &QVector<T>::append;
-    mt["at"] = &QVector<T>::at;
+    mt["at"] = &QVector_at<T>;
     mt["back"] = &QVector_back<T>;
-    mt["begin"] = &QVector_begin<T>;
     mt["capacity"] = &QVector<T>::capacity;
-    mt["cbegin"] = &QVector<T>::cbegin;
-    mt["cend"] = &QVector<T>::cend;
     mt["clear"] = &QVector<T>::clear;
-    mt["constBegin"] = &QVector<T>::constBegin;
-    mt["constData"] = &QVector<T>::constData;
-    mt["constEnd"] = &QVector<T>::constEnd;
     mt["contains"] = &QVector<T>::contains;
     mt["count"] = &QVector_count<T>;
     mt["data"] = &QVector_data<T>;
     mt["empty"] = &QVector<T>::empty;
-    mt["end"] = &QVector_end<T>;
     mt["endsWith"] = &QVector<T>::endsWith;
-    mt["erase"] = &QVector_erase<T>;
     mt["fill"] = &QVector<T>::fill;
     mt["first"] = &QVector_first<T>;
     mt["front"] = &QVector_front<T>;
@@ -149,17 +200,17 @@ void QVector_metatable(const lua::index& mt)
     mt["push_back"] = &QVector<T>::push_back;
     mt["push_front"] = &QVector<T>::push_front;
     mt["remove"] = &QVector_remove<T>;
-    mt["removeAt"] = &QVector<T>::removeAt;
+    mt["removeAt"] = &QVector_remove<T>;
     mt["removeFirst"] = &QVector<T>::removeFirst;
     mt["removeLast"] = &QVector<T>::removeLast;
-    mt["replace"] = &QVector<T>::replace;
+    mt["replace"] = &QVector_replace<T>;
     mt["reserve"] = &QVector<T>::reserve;
     mt["resize"] = &QVector<T>::resize;
     mt["size"] = &QVector<T>::size;
     mt["squeeze"] = &QVector<T>::squeeze;
     mt["startsWith"] = &QVector<T>::startsWith;
     mt["swap"] = &QVector<T>::swap;
-    mt["takeAt"] = &QVector<T>::takeAt;
+    mt["takeAt"] = &QVector_takeAt<T>;
     mt["takeFirst"] = &QVector<T>::takeFirst;
     mt["takeLast"] = &QVector<T>::takeLast;
     mt["toList"] = &QVector<T>::toList;
@@ -181,6 +232,10 @@ struct Metatable<QVector<T>>
 
 }; // namespace lua
 
+LUACXX_SEQUENCE_VIEW_NAMES(QVector)
+LUACXX_SEQUENCE_VIEW_NAME(QVector<QPoint>)
+LUACXX_SEQUENCE_VIEW_NAME(QVector<QPointF>)
+
 extern "C" int luaopen_Qt5Core_QVector(lua_State* const);
 
 #endif // LUACXX_QVECTOR_INCLUDED
@@ -2,15 +2,16 @@
 #define LUACXX_QT_INCLUDED
 
 #include "../stack.hpp"
-#include "../global.hpp"
+#include "../pinned.hpp"
+#include "QFlags.hpp"
 #include <Qt>
 
 namespace lua {
 
-void qt_constants_1(lua::global& t);
-void qt_constants_2(lua::global& t);
-void qt_constants_3(lua::global& t);
-void qt_constants_4(lua::global& t);
+void qt_constants_1(const lua::pinned& t);
+void qt_constants_2(const lua::pinned& t);
+void qt_constants_3(const lua::pinned& t);
+void qt_constants_4(const lua::pinned& t);
 
 template <>
 struct Metatable<Qt::BrushStyle>
@@ -12,7 +12,7 @@ int luaopen_Qt5Core_Qt(lua_State* const state)
     lua::thread env(state);
 
     env["Qt"] = lua::value::table;
-    auto t = env["Qt"];
+    lua::pinned t(env["Qt"]);
 
     lua::qt_constants_1(t);
     lua::qt_constants_2(t);
@@ -22,7 +22,7 @@ int luaopen_Qt5Core_Qt(lua_State* const state)
     return 0;
 }
 
-void lua::qt_constants_1(lua::global& t)
+void lua::qt_constants_1(const lua::pinned& t)
 {
     // Qt::AlignmentFlag
     // Qt::Alignment
@@ -5,7 +5,7 @@
 
 #include <Qt>
 
-void lua::qt_constants_2(lua::global& t)
+void lua::qt_constants_2(const lua::pinned& t)
 {
     // enum Qt::Key
     t["Key_Escape"] = Qt::Key_Escape;
@@ -5,7 +5,7 @@
 
 #include <Qt>
 
-void lua::qt_constants_3(lua::global& t)
+void lua::qt_constants_3(const lua::pinned& t)
 {
     // enum Qt::KeyboardModifier
     // flags Qt::KeyboardModifiers
@@ -5,7 +5,7 @@
 
 #include <Qt>
 
-void lua::qt_constants_4(lua::global& t)
+void lua::qt_constants_4(const lua::pinned& t)
 {
     // enum Qt::WidgetAttribute
     t["WA_AcceptDrops"] = Qt::WA_AcceptDrops;
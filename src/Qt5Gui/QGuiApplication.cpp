@@ -45,7 +45,7 @@ int luaopen_Qt5Gui_QGuiApplication(lua_State* const state)
 
     env["QGuiApplication"] = lua::value::table;
     env["QGuiApplication"]["new"] = lua::QCoreApplication_new<QGuiApplication>;
-    auto t = env["QGuiApplication"];
+    lua::pinned t(env["QGuiApplication"]);
 
     t["allWindows"] = &QGuiApplication::allWindows;
     t["applicationDisplayName"] = &QGuiApplication::applicationDisplayName;
@@ -92,7 +92,7 @@ int luaopen_Qt5Gui_QIcon(lua_State* const state)
     lua::thread env(state);
 
     env["QIcon"] = lua::value::table;
-    auto t = env["QIcon"];
+    lua::pinned t(env["QIcon"]);
 
     t["new"] = QIcon_new;
     t["fromTheme"] = &QIcon::fromTheme;
@@ -160,7 +160,7 @@ int luaopen_Qt5Gui_QImage(lua_State* const state)
     env["QImage"] = lua::value::table;
     env["QImage"]["new"] = QImage_new;
 
-    auto t = env["QImage"];
+    lua::pinned t(env["QImage"]);
 
     // enum QImage::Format
     t["Format_Invalid"] = QImage::Format_Invalid;
@@ -4,138 +4,56 @@
 #include "../convert/numeric.hpp"
 #include "../convert/vector.hpp"
 
+#include "../overload.hpp"
+#include "../sequence_view.hpp"
+#include "../table_view.hpp"
 #include "../thread.hpp"
+#include "../Qt5Core/QString.hpp"
 #include "../Qt5Core/QRect.hpp"
 #include "../Qt5Core/QRectF.hpp"
+#include "../Qt5Core/QVector.hpp"
+#include "QPolygonF.hpp"
 #include "QTextOption.hpp"
 #include "../Qt5Core/Qt.hpp"
 
 #include <QPaintEngine>
 
+#include <sstream>
+
 /*
 
 QVector and QString are treated as tables and strings, respectively.
 
-*/
-
-int QPainter_boundingRect(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-    if (lua_type(state, 2) != LUA_TUSERDATA) {
-        // QRect boundingRect(int x, int y, int w, int h, int flags, const QString & text)
-        lua::push(state, self->boundingRect(
-            lua::get<int>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<int>(state, 4),
-            lua::get<int>(state, 5),
-            lua::get<int>(state, 6),
-            lua::get<const char*>(state, 7)
-        ));
-        return 1;
-    }
-
-    if (lua::is_type<QRect>(state, 2)) {
-        // QRect boundingRect(const QRect & rectangle, int flags, const QString & text)
-        lua::push(state, self->boundingRect(
-            lua::get<const QRect&>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<const char*>(state, 4)
-        ));
-        return 1;
-    }
-    if (lua_type(state, 3) == LUA_TNUMBER) {
-        // QRectF boundingRect(const QRectF & rectangle, int flags, const QString & text)
-        lua::push(state, self->boundingRect(
-            lua::get<const QRectF&>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<const char*>(state, 4)
-        ));
-        return 1;
-    }
+Functions that take a list of points also accept a lua::sequence_view of a
+QPolygonF, QVector<QPointF>, or std::vector<QPointF>, whose points are passed
+directly rather than copied.
 
-    // QRectF boundingRect(const QRectF & rectangle, const QString & text, const QTextOption & option = QTextOption())
-    if (lua_gettop(state) > 3) {
-        lua::push(state, self->boundingRect(
-            lua::get<const QRectF&>(state, 2),
-            lua::get<const char*>(state, 3),
-            lua::get<const QTextOption&>(state, 4)
-        ));
-        return 1;
-    }
+*/
 
-    lua::push(state, self->boundingRect(
-        lua::get<const QRectF&>(state, 2),
-        lua::get<const char*>(state, 3)
-    ));
-    return 1;
-}
+namespace {
 
-int QPainter_drawArc(lua_State* const state)
+template <class Container>
+bool get_point_view(lua_State* const state, const int pos, const QPointF*& points, int& count)
 {
-    auto self = lua::get<QPainter*>(state, 1);
-    if (lua_gettop(state) == 4) {
-        if (lua::is_type<QRect>(state, 2)) {
-            // void drawArc( const QRect & rectangle, int startAngle, int spanAngle )
-            self->drawArc(
-                lua::get<const QRect&>(state, 2),
-                lua::get<int>(state, 3),
-                lua::get<int>(state, 4)
-            );
-        }
-        // void drawArc( const QRectF & rectangle, int startAngle, int spanAngle )
-        self->drawArc(
-            lua::get<const QRectF&>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<int>(state, 4)
-        );
-        return 0;
+    if (!lua::is_type<lua::sequence_view<Container>>(state, pos)) {
+        return false;
     }
-
-    // void drawArc( int x, int y, int width, int height, int startAngle, int spanAngle )
-    self->drawArc(
-        lua::get<int>(state, 2), // x
-        lua::get<int>(state, 3), // y
-        lua::get<int>(state, 4), // width
-        lua::get<int>(state, 5), // height
-        lua::get<int>(state, 6), // startAngle
-        lua::get<int>(state, 7) // spanAngle
-    );
-    return 0;
+    const Container& container = lua::get<lua::sequence_view<Container>&>(state, pos).container();
+    points = container.data();
+    count = container.size();
+    return true;
 }
 
-int QPainter_drawChord(lua_State* const state)
+// Finds the points of the sequence view at pos, if it is one.
+bool get_point_view(lua_State* const state, const int pos, const QPointF*& points, int& count)
 {
-    auto self = lua::get<QPainter*>(state, 1);
-    if (lua_gettop(state) == 4) {
-        if (lua::is_type<QRect>(state, 2)) {
-            // void drawChord( const QRect & rectangle, int startAngle, int spanAngle )
-            self->drawChord(
-                lua::get<const QRect&>(state, 2),
-                lua::get<int>(state, 3),
-                lua::get<int>(state, 4)
-            );
-        }
-        // void drawChord( const QRectF & rectangle, int startAngle, int spanAngle )
-        self->drawChord(
-            lua::get<const QRectF&>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<int>(state, 4)
-        );
-        return 0;
-    }
-
-    // void drawChord( int x, int y, int width, int height, int startAngle, int spanAngle )
-    self->drawChord(
-        lua::get<int>(state, 2), // x
-        lua::get<int>(state, 3), // y
-        lua::get<int>(state, 4), // width
-        lua::get<int>(state, 5), // height
-        lua::get<int>(state, 6), // startAngle
-        lua::get<int>(state, 7) // spanAngle
-    );
-    return 0;
+    return get_point_view<QPolygonF>(state, pos, points, count)
+        || get_point_view<QVector<QPointF>>(state, pos, points, count)
+        || get_point_view<std::vector<QPointF>>(state, pos, points, count);
 }
 
+} // namespace anonymous
+
 int QPainter_drawConvexPolygon(lua_State* const state)
 {
     auto self = lua::get<QPainter*>(state, 1);
@@ -196,264 +114,6 @@ int QPainter_drawConvexPolygon(lua_State* const state)
     return 0;
 }
 
-int QPainter_drawEllipse(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-    if (lua_gettop(state) == 2) {
-        if (lua::is_type<QRectF>(state, 2)) {
-            // void    drawEllipse ( const QRectF & rectangle )
-            self->drawEllipse(lua::get<const QRectF&>(state, 2));
-            return 0;
-        }
-
-        // void    drawEllipse ( const QRect & rectangle )
-        self->drawEllipse(lua::get<const QRect&>(state, 2));
-        return 0;
-    }
-
-    if (lua_gettop(state) >= 4) {
-        // void    drawEllipse ( int x, int y, int width, int height )
-        self->drawEllipse(
-            lua::get<int>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<int>(state, 4),
-            lua::get<int>(state, 5)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QPointF>(state, 2)) {
-        // void    drawEllipse ( const QPointF & center, qreal rx, qreal ry )
-        self->drawEllipse(
-            lua::get<const QPointF&>(state, 2),
-            lua::get<qreal>(state, 3),
-            lua::get<qreal>(state, 4)
-        );
-        return 0;
-    }
-
-    // void    drawEllipse ( const QPoint & center, int rx, int ry )
-    self->drawEllipse(
-        lua::get<const QPoint&>(state, 2),
-        lua::get<int>(state, 3),
-        lua::get<int>(state, 4)
-    );
-    return 0;
-}
-
-int QPainter_drawImage(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    // void    drawImage ( const QRectF & rectangle, const QImage & image )
-    // void    drawImage ( const QRectF & target, const QImage & image, const QRectF & source, Qt::ImageConversionFlags flags = Qt::AutoColor )
-    if (lua::is_type<QRectF>(state, 2)) {
-        switch (lua_gettop(state)) {
-            case 3:
-            {
-                self->drawImage(
-                    lua::get<const QRectF&>(state, 2),
-                    lua::get<const QImage&>(state, 3)
-                );
-                return 0;
-            }
-            case 4:
-            {
-                self->drawImage(
-                    lua::get<const QRectF&>(state, 2),
-                    lua::get<const QImage&>(state, 3),
-                    lua::get<const QRectF&>(state, 4)
-                );
-                return 0;
-            }
-            default:
-            {
-                self->drawImage(
-                    lua::get<const QRectF&>(state, 2),
-                    lua::get<const QImage&>(state, 3),
-                    lua::get<const QRectF&>(state, 4),
-                    lua::get<Qt::ImageConversionFlags>(state, 5)
-                );
-                return 0;
-            }
-        }
-        return 0;
-    }
-
-    // void    drawImage ( const QRect & target, const QImage & image, const QRect & source, Qt::ImageConversionFlags flags = Qt::AutoColor )
-    // void    drawImage ( const QRect & rectangle, const QImage & image )
-    if (lua::is_type<QRect>(state, 2)) {
-        switch (lua_gettop(state)) {
-            case 3:
-            {
-                self->drawImage(
-                    lua::get<const QRect&>(state, 2),
-                    lua::get<const QImage&>(state, 3)
-                );
-                return 0;
-            }
-            case 4:
-            {
-                self->drawImage(
-                    lua::get<const QRect&>(state, 2),
-                    lua::get<const QImage&>(state, 3),
-                    lua::get<const QRectF&>(state, 4)
-                );
-                return 0;
-            }
-            default:
-            {
-                self->drawImage(
-                    lua::get<const QRect&>(state, 2),
-                    lua::get<const QImage&>(state, 3),
-                    lua::get<const QRectF&>(state, 4),
-                    lua::get<Qt::ImageConversionFlags>(state, 5)
-                );
-                return 0;
-            }
-        }
-        return 0;
-    }
-
-    // void    drawImage ( const QPointF & point, const QImage & image )
-    // void    drawImage ( const QPointF & point, const QImage & image, const QRectF & source, Qt::ImageConversionFlags flags = Qt::AutoColor )
-    if (lua::is_type<QPointF>(state, 2)) {
-        switch (lua_gettop(state)) {
-            case 3:
-            {
-                self->drawImage(
-                    lua::get<const QPointF&>(state, 2),
-                    lua::get<const QImage&>(state, 3)
-                );
-                return 0;
-            }
-            case 4:
-            {
-                self->drawImage(
-                    lua::get<const QPointF&>(state, 2),
-                    lua::get<const QImage&>(state, 3),
-                    lua::get<const QRectF&>(state, 4)
-                );
-                return 0;
-            }
-            default:
-            {
-                self->drawImage(
-                    lua::get<const QPointF&>(state, 2),
-                    lua::get<const QImage&>(state, 3),
-                    lua::get<const QRectF&>(state, 4),
-                    lua::get<Qt::ImageConversionFlags>(state, 5)
-                );
-                return 0;
-            }
-        }
-        return 0;
-    }
-
-    // void    drawImage ( const QPoint & point, const QImage & image )
-    // void    drawImage ( const QPoint & point, const QImage & image, const QRect & source, Qt::ImageConversionFlags flags = Qt::AutoColor )
-    if (lua::is_type<QPoint>(state, 2)) {
-        switch (lua_gettop(state)) {
-            case 3:
-            {
-                self->drawImage(
-                    lua::get<const QPoint&>(state, 2),
-                    lua::get<const QImage&>(state, 3)
-                );
-                return 0;
-            }
-            case 4:
-            {
-                self->drawImage(
-                    lua::get<const QPoint&>(state, 2),
-                    lua::get<const QImage&>(state, 3),
-                    lua::get<const QRectF&>(state, 4)
-                );
-                return 0;
-            }
-            default:
-            {
-                self->drawImage(
-                    lua::get<const QPoint&>(state, 2),
-                    lua::get<const QImage&>(state, 3),
-                    lua::get<const QRectF&>(state, 4),
-                    lua::get<Qt::ImageConversionFlags>(state, 5)
-                );
-                return 0;
-            }
-        }
-        return 0;
-    }
-
-    // void    drawImage ( int x, int y, const QImage & image, int sx = 0, int sy = 0, int sw = -1, int sh = -1, Qt::ImageConversionFlags flags = Qt::AutoColor )
-    if (lua_gettop(state) == 8) {
-        self->drawImage(
-            lua::get<int>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<const QImage&>(state, 4),
-            lua::get<int>(state, 5),
-            lua::get<int>(state, 6),
-            lua::get<int>(state, 7),
-            lua::get<int>(state, 8)
-        );
-    }
-
-    self->drawImage(
-        lua::get<int>(state, 2),
-        lua::get<int>(state, 3),
-        lua::get<const QImage&>(state, 4),
-        lua::get<int>(state, 5),
-        lua::get<int>(state, 6),
-        lua::get<int>(state, 7),
-        lua::get<int>(state, 8),
-        lua::get<Qt::ImageConversionFlags>(state, 9)
-    );
-    return 0;
-}
-
-int QPainter_drawLine(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    if (lua_gettop(state) == 2) {
-        if (lua::is_type<QLineF>(state, 2)) {
-            // void drawLine(const QLineF & line)
-            self->drawLine(lua::get<const QLineF&>(state, 2));
-            return 0;
-        }
-
-        // void drawLine(const QLine & line)
-        self->drawLine(lua::get<const QLine&>(state, 2));
-        return 0;
-    }
-    if (lua_gettop(state) == 3) {
-        if (lua::is_type<QPointF>(state, 2)) {
-            // void drawLine(const QPointF & p1, const QPointF & p2)
-            self->drawLine(
-                lua::get<const QPointF&>(state, 2),
-                lua::get<const QPointF&>(state, 3)
-            );
-            return 0;
-        }
-
-        // void drawLine(const QPoint & p1, const QPoint & p2)
-        self->drawLine(
-            lua::get<const QPoint&>(state, 2),
-            lua::get<const QPoint&>(state, 3)
-        );
-        return 0;
-    }
-
-    // void drawLine(int x1, int y1, int x2, int y2)
-    self->drawLine(
-        lua::get<int>(state, 2),
-        lua::get<int>(state, 3),
-        lua::get<int>(state, 4),
-        lua::get<int>(state, 5)
-    );
-    return 0;
-}
-
 int QPainter_drawLines(lua_State* const state)
 {
     auto self = lua::get<QPainter*>(state, 1);
@@ -495,199 +155,47 @@ int QPainter_drawLines(lua_State* const state)
         return 0;
     }
 
-    return 0;
-}
-
-int QPainter_drawPicture(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    if (lua_gettop(state) > 3) {
-        // void drawPicture(int x, int y, const QPicture & picture)
-        self->drawPicture(
-            lua::get<int>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<const QPicture&>(state, 4)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QPoint>(state, 2)) {
-        // void drawPicture(const QPoint & point, const QPicture & picture)
-        self->drawPicture(
-            lua::get<const QPoint&>(state, 2),
-            lua::get<const QPicture&>(state, 3)
-        );
-        return 0;
-    }
-
-    // void drawPicture(const QPointF & point, const QPicture & picture)
-    self->drawPicture(
-        lua::get<const QPointF&>(state, 2),
-        lua::get<const QPicture&>(state, 3)
-    );
-    return 0;
-}
-
-int QPainter_drawPie(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    if (lua_gettop(state) > 3) {
-        // void drawPie(int x, int y, int width, int height, int startAngle, int spanAngle)
-        self->drawPie(
-            lua::get<int>(state, 2), // x
-            lua::get<int>(state, 3), // y
-            lua::get<int>(state, 4), // width
-            lua::get<int>(state, 5), // height
-            lua::get<int>(state, 6), // startAngle
-            lua::get<int>(state, 7)  // spanAngle
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QRect>(state, 2)) {
-        // void drawPie(const QRect & rectangle, int startAngle, int spanAngle)
-        self->drawPie(
-            lua::get<const QRect&>(state, 2),
-            lua::get<int>(state, 3), // startAngle
-            lua::get<int>(state, 4)  // spanAngle
-        );
-        return 0;
-    }
-
-    // void drawPie(const QRectF & rectangle, int startAngle, int spanAngle)
-    self->drawPie(
-        lua::get<const QRectF&>(state, 2),
-        lua::get<int>(state, 3), // startAngle
-        lua::get<int>(state, 4)  // spanAngle
-    );
-    return 0;
-}
-
-int QPainter_drawPixmap(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    if (lua_type(state, 2) == LUA_TNUMBER) {
-        switch (lua_gettop(state)) {
-        case 6: {
-            // void drawPixmap(int x, int y, int width, int height, const QPixmap & pixmap)
-            self->drawPixmap(
-                lua::get<int>(state, 2),
-                lua::get<int>(state, 3),
-                lua::get<int>(state, 4),
-                lua::get<int>(state, 5),
-                lua::get<const QPixmap&>(state, 6)
-            );
-            return 0;
-        }
-        case 10:
-        {
-            // void drawPixmap(int x, int y, int w, int h, const QPixmap & pixmap, int sx, int sy, int sw, int sh)
-            self->drawPixmap(
-                lua::get<int>(state, 2),
-                lua::get<int>(state, 3),
-                lua::get<int>(state, 4),
-                lua::get<int>(state, 5),
-                lua::get<const QPixmap&>(state, 6),
-                lua::get<int>(state, 7),
-                lua::get<int>(state, 8),
-                lua::get<int>(state, 9),
-                lua::get<int>(state, 10)
-            );
-        }
-        case 8:
-        {
-            // void drawPixmap(int x, int y, const QPixmap & pixmap, int sx, int sy, int sw, int sh)
-            self->drawPixmap(
-                lua::get<int>(state, 2),
-                lua::get<int>(state, 3),
-                lua::get<const QPixmap&>(state, 4),
-                lua::get<int>(state, 5),
-                lua::get<int>(state, 6),
-                lua::get<int>(state, 7),
-                lua::get<int>(state, 8)
-            );
-        }
-        default:
-        {
-            // void drawPixmap(int x, int y, const QPixmap & pixmap)
-            self->drawPixmap(
-                lua::get<int>(state, 2),
-                lua::get<int>(state, 3),
-                lua::get<const QPixmap&>(state, 4)
-            );
-        }
-        }
-    }
-
-    auto pixmap = lua::get<const QPixmap&>(state, 3);
-
-    if (lua::is_type<QPointF>(state, 2)) {
-        if (lua_gettop(state) > 3) {
-            // void drawPixmap(const QPointF & point, const QPixmap & pixmap, const QRectF & source)
-            self->drawPixmap(
-                lua::get<const QPoint&>(state, 2),
-                pixmap,
-                lua::get<const QRectF&>(state, 4)
-            );
-            return 0;
-        }
-
-        // void drawPixmap(const QPointF & point, const QPixmap & pixmap)
-        self->drawPixmap(
-            lua::get<const QPoint&>(state, 2),
-            pixmap
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QPoint>(state, 2)) {
-        if (lua_gettop(state) > 3) {
-            // void drawPixmap(const QPoint & point, const QPixmap & pixmap, const QRect & source)
-            self->drawPixmap(
-                lua::get<const QPoint&>(state, 2),
-                pixmap,
-                lua::get<const QRect&>(state, 4)
-            );
-            return 0;
+    if (lua_type(state, 2) == LUA_TTABLE) {
+        // A view can't tell a QLine from a QLineF, so check every line's class
+        // before reading them as the first line's type.
+        auto count = lua_rawlen(state, 2);
+        bool integral = false;
+        for (size_t i = 1; i <= count; ++i) {
+            lua_rawgeti(state, 2, i);
+            if (i == 1) {
+                integral = lua::is_type<QLine>(state, -1);
+            }
+            bool matches = integral ? lua::is_type<QLine>(state, -1) : lua::is_type<QLineF>(state, -1);
+            lua_pop(state, 1);
+            if (!matches) {
+                std::stringstream str;
+                str << "QPainter.drawLines: Line " << i << " must be a "
+                    << (integral ? "QLine" : "QLineF") << ", like the first line";
+                throw lua::error(str.str());
+            }
         }
 
-        // void drawPixmap(const QPoint & point, const QPixmap & pixmap)
-        self->drawPixmap(
-            lua::get<const QPoint&>(state, 2),
-            pixmap
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QRect>(state, 2)) {
-        if (lua_gettop(state) > 3) {
-            // void drawPixmap(const QRect & point, const QPixmap & pixmap, const QRectF & source)
-            self->drawPixmap(
-                lua::get<const QRect&>(state, 2),
-                pixmap,
-                lua::get<const QRect&>(state, 4)
-            );
-            return 0;
+        // QPainter needs the lines side by side, but each is its own userdata,
+        // so they're copied once into a vector.
+        if (integral) {
+            // void drawLines(const QVector<QLine> & lines)
+            lua::table_view<const QLine&> view(lua::index(state, 2));
+            QVector<QLine> lines;
+            lines.reserve(view.size());
+            for (const QLine& line : view) {
+                lines.append(line);
+            }
+            self->drawLines(lines);
+        } else {
+            // void drawLines(const QVector<QLineF> & lines)
+            lua::table_view<const QLineF&> view(lua::index(state, 2));
+            QVector<QLineF> lines;
+            lines.reserve(view.size());
+            for (const QLineF& line : view) {
+                lines.append(line);
+            }
+            self->drawLines(lines);
         }
-
-        // void drawPixmap(const QRect & point, const QPixmap & pixmap)
-        self->drawPixmap(
-            lua::get<const QRect&>(state, 2),
-            pixmap
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QRectF>(state, 2)) {
-        // void drawPixmap(const QRectF & target, const QPixmap & pixmap, const QRectF & source)
-        self->drawPixmap(
-            lua::get<const QRectF&>(state, 2),
-            pixmap,
-            lua::get<const QRectF&>(state, 4)
-        );
         return 0;
     }
 
@@ -718,37 +226,17 @@ int QPainter_drawPixmapFragments(lua_State* const state)
     return 0;
 }
 
-int QPainter_drawPoint(lua_State* const state)
+int QPainter_drawPoints(lua_State* const state)
 {
     auto self = lua::get<QPainter*>(state, 1);
 
-    if (lua_gettop(state) > 2) {
-        // void drawPoint(int x, int y)
-        self->drawPoint(
-            lua::get<int>(state, 2),
-            lua::get<int>(state, 3)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QPoint>(state, 2)) {
-        // void drawPoint(const QPoint & position)
-        self->drawPoint(
-            lua::get<const QPoint&>(state, 2)
-        );
+    const QPointF* points = nullptr;
+    int count = 0;
+    if (get_point_view(state, 2, points, count)) {
+        self->drawPoints(points, count);
         return 0;
     }
 
-    // void drawPoint(const QPointF & position)
-    self->drawPoint(
-        lua::get<const QPointF&>(state, 2)
-    );
-    return 0;
-}
-
-int QPainter_drawPoints(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
     if (lua_gettop(state) > 2) {
         if (lua::is_type<QPointF>(state, 2)) {
             // void drawPoints(const QPointF * points, int pointCount)
@@ -756,12 +244,14 @@ int QPainter_drawPoints(lua_State* const state)
                 lua::get<const QPointF*>(state, 2),
                 lua::get<int>(state, 3)
             );
+            return 0;
         }
         // void drawPoints(const QPoint * points, int pointCount)
         self->drawPoints(
             lua::get<const QPoint*>(state, 2),
             lua::get<int>(state, 3)
         );
+        return 0;
     }
 
     if (lua_type(state, 2) == LUA_TTABLE) {
@@ -797,6 +287,17 @@ int QPainter_drawPolygon(lua_State* const state)
 {
     auto self = lua::get<QPainter*>(state, 1);
 
+    const QPointF* points = nullptr;
+    int count = 0;
+    if (get_point_view(state, 2, points, count)) {
+        if (lua_gettop(state) == 3) {
+            self->drawPolygon(points, count, lua::get<Qt::FillRule>(state, 3));
+        } else {
+            self->drawPolygon(points, count);
+        }
+        return 0;
+    }
+
     if (lua_type(state, 2) == LUA_TTABLE) {
         lua_rawgeti(state, 2, 1);
         if (lua::is_type<QPointF>(state, -1)) {
@@ -866,6 +367,13 @@ int QPainter_drawPolyline(lua_State* const state)
 {
     auto self = lua::get<QPainter*>(state, 1);
 
+    const QPointF* points = nullptr;
+    int count = 0;
+    if (get_point_view(state, 2, points, count)) {
+        self->drawPolyline(points, count);
+        return 0;
+    }
+
     if (lua_type(state, 2) == LUA_TTABLE) {
         lua_rawgeti(state, 2, 1);
         if (lua::is_type<QPointF>(state, -1)) {
@@ -902,37 +410,7 @@ int QPainter_drawPolyline(lua_State* const state)
     return 0;
 }
 
-int QPainter_drawRect(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    if (lua_gettop(state) > 2) {
-        // void drawRect(int x, int y, int width, int height)
-        self->drawRect(
-            lua::get<int>(state, 3),
-            lua::get<int>(state, 4),
-            lua::get<int>(state, 5),
-            lua::get<int>(state, 6)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QRectF>(state, 2)) {
-        // void drawRect(const QRectF & rectangle)
-        self->drawRect(
-            lua::get<const QRectF&>(state, 2)
-        );
-        return 0;
-    }
-
-    // void drawRect(const QRect & rectangle)
-    self->drawRect(
-        lua::get<const QRect&>(state, 2)
-    );
-    return 0;
-}
-
-int QPainter_drawRects(lua_State* const state)
+int QPainter_drawRects(lua_State* const state)
 {
     auto self = lua::get<QPainter*>(state, 1);
 
@@ -970,657 +448,22 @@ int QPainter_drawRects(lua_State* const state)
     return 0;
 }
 
-int QPainter_drawRoundedRect(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    if (lua_type(state, 2) == LUA_TNUMBER) {
-        // void drawRoundedRect(int x, int y, int w, int h, qreal xRadius, qreal yRadius, Qt::SizeMode mode = Qt::AbsoluteSize)
-        if (lua_gettop(state) > 7) {
-            self->drawRoundedRect(
-                lua::get<int>(state, 2),
-                lua::get<int>(state, 3),
-                lua::get<int>(state, 4),
-                lua::get<int>(state, 5),
-                lua::get<qreal>(state, 6),
-                lua::get<qreal>(state, 7),
-                lua::get<Qt::SizeMode>(state, 8)
-            );
-        }
-        self->drawRoundedRect(
-            lua::get<int>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<int>(state, 4),
-            lua::get<int>(state, 5),
-            lua::get<qreal>(state, 6),
-            lua::get<qreal>(state, 7)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QRect>(state, 2)) {
-        // void drawRoundedRect(const QRect & rect, qreal xRadius, qreal yRadius, Qt::SizeMode mode = Qt::AbsoluteSize)
-        if (lua_gettop(state) > 4) {
-            self->drawRoundedRect(
-                lua::get<const QRect&>(state, 2),
-                lua::get<qreal>(state, 3),
-                lua::get<qreal>(state, 4),
-                lua::get<Qt::SizeMode>(state, 5)
-            );
-        }
-        self->drawRoundedRect(
-            lua::get<const QRect&>(state, 2),
-            lua::get<qreal>(state, 3),
-            lua::get<qreal>(state, 4)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QRectF>(state, 2)) {
-        // void drawRoundedRect(const QRectF & rect, qreal xRadius, qreal yRadius, Qt::SizeMode mode = Qt::AbsoluteSize)
-        if (lua_gettop(state) > 4) {
-            self->drawRoundedRect(
-                lua::get<const QRectF&>(state, 2),
-                lua::get<qreal>(state, 3),
-                lua::get<qreal>(state, 4),
-                lua::get<Qt::SizeMode>(state, 5)
-            );
-        }
-        self->drawRoundedRect(
-            lua::get<const QRectF&>(state, 2),
-            lua::get<qreal>(state, 3),
-            lua::get<qreal>(state, 4)
-        );
-        return 0;
-    }
-
-    return 0;
-}
-
-int QPainter_drawStaticText(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    if (lua_gettop(state) > 3) {
-        // void drawStaticText(int left, int top, const QStaticText & staticText)
-        self->drawStaticText(
-            lua::get<int>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<const QStaticText&>(state, 4)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QPointF>(state, 2)) {
-        // void drawStaticText(const QPointF & topLeftPosition, const QStaticText & staticText)
-        self->drawStaticText(
-            lua::get<const QPointF&>(state, 2),
-            lua::get<const QStaticText&>(state, 3)
-        );
-        return 0;
-    }
-
-    // void drawStaticText(const QPoint & topLeftPosition, const QStaticText & staticText)
-    self->drawStaticText(
-        lua::get<const QPoint&>(state, 2),
-        lua::get<const QStaticText&>(state, 3)
-    );
-    return 0;
-}
-
-int QPainter_drawText(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    if (lua_type(state, 2) == LUA_TNUMBER) {
-        // void drawText(int x, int y, int width, int height, int flags, const QString & text, QRect * boundingRect = 0)
-        if (lua_gettop(state) > 4) {
-            if (lua_gettop(state) == 8) {
-                self->drawText(
-                    lua::get<int>(state, 2),
-                    lua::get<int>(state, 3),
-                    lua::get<int>(state, 4),
-                    lua::get<int>(state, 5),
-                    lua::get<int>(state, 6),
-                    lua::get<const char*>(state, 7),
-                    lua::get<QRect*>(state, 8)
-                );
-            }
-
-            self->drawText(
-                lua::get<int>(state, 2),
-                lua::get<int>(state, 3),
-                lua::get<int>(state, 4),
-                lua::get<int>(state, 5),
-                lua::get<int>(state, 6),
-                lua::get<const char*>(state, 7)
-            );
-            return 0;
-        }
-
-        // void drawText(int x, int y, const QString & text)
-        self->drawText(
-            lua::get<int>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<const char*>(state, 4)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QPointF>(state, 2)) {
-        // void drawText(const QPointF & position, const QString & text)
-        self->drawText(
-            lua::get<const QPointF&>(state, 2),
-            lua::get<const char*>(state, 3)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QPoint>(state, 2)) {
-        // void drawText(const QPoint & position, const QString & text)
-        self->drawText(
-            lua::get<const QPoint&>(state, 2),
-            lua::get<const char*>(state, 3)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QRect>(state, 2)) {
-        // void drawText(const QRect & rectangle, int flags, const QString & text, QRect * boundingRect = 0)
-        if (lua_gettop(state) == 5) {
-            self->drawText(
-                lua::get<const QRect&>(state, 2),
-                lua::get<int>(state, 3),
-                lua::get<const char*>(state, 4),
-                lua::get<QRect*>(state, 5)
-            );
-            return 0;
-        }
-        self->drawText(
-            lua::get<const QRect&>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<const char*>(state, 4)
-        );
-        return 0;
-    }
-
-    if (lua_type(state, 3) == LUA_TNUMBER) {
-        // void drawText(const QRectF & rectangle, int flags, const QString & text, QRectF * boundingRect = 0)
-        if (lua_gettop(state) == 5) {
-            self->drawText(
-                lua::get<const QRectF&>(state, 2),
-                lua::get<int>(state, 3),
-                lua::get<const char*>(state, 4),
-                lua::get<QRectF*>(state, 5)
-            );
-            return 0;
-        }
-        self->drawText(
-            lua::get<const QRectF&>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<const char*>(state, 4)
-        );
-    }
-
-    // void drawText(const QRectF & rectangle, const QString & text, const QTextOption & option = QTextOption())
-    if (lua_gettop(state) == 4) {
-        self->drawText(
-            lua::get<const QRectF&>(state, 2),
-            lua::get<const char*>(state, 3),
-            lua::get<const QTextOption&>(state, 4)
-        );
-        return 0;
-    }
-    self->drawText(
-        lua::get<const QRectF&>(state, 2),
-        lua::get<const char*>(state, 3)
-    );
-    return 0;
-}
-
-int QPainter_drawTiledPixmap(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    if (lua_gettop(state) > 5) {
-        // void drawTiledPixmap(int x, int y, int width, int height, const QPixmap & pixmap, int sx = 0, int sy = 0)
-        switch (lua_gettop(state)) {
-        case 6:
-            self->drawTiledPixmap(
-                lua::get<int>(state, 2),
-                lua::get<int>(state, 3),
-                lua::get<int>(state, 4),
-                lua::get<int>(state, 5),
-                lua::get<const QPixmap&>(state, 6)
-            );
-            return 0;
-        case 7:
-            self->drawTiledPixmap(
-                lua::get<int>(state, 2),
-                lua::get<int>(state, 3),
-                lua::get<int>(state, 4),
-                lua::get<int>(state, 5),
-                lua::get<const QPixmap&>(state, 6),
-                lua::get<int>(state, 7) // sx
-            );
-            return 0;
-        default:
-            self->drawTiledPixmap(
-                lua::get<int>(state, 2),
-                lua::get<int>(state, 3),
-                lua::get<int>(state, 4),
-                lua::get<int>(state, 5),
-                lua::get<const QPixmap&>(state, 6),
-                lua::get<int>(state, 7), // sx
-                lua::get<int>(state, 8) // sy
-            );
-            return 0;
-        }
-    }
-
-    if (lua::is_type<QRect>(state, 2)) {
-        if (lua_gettop(state) >= 4) {
-            // void drawTiledPixmap(const QRect & rectangle, const QPixmap & pixmap, const QPoint & position)
-            self->drawTiledPixmap(
-                lua::get<const QRect&>(state, 2),
-                lua::get<const QPixmap&>(state, 3),
-                lua::get<const QPoint&>(state, 4)
-            );
-            return 0;
-        }
-        // void drawTiledPixmap(const QRect & rectangle, const QPixmap & pixmap)
-        self->drawTiledPixmap(
-            lua::get<const QRect&>(state, 2),
-            lua::get<const QPixmap&>(state, 3)
-        );
-        return 0;
-    }
-
-    if (lua_gettop(state) >= 4) {
-        // void drawTiledPixmap(const QRectF & rectangle, const QPixmap & pixmap, const QPointF & position)
-        self->drawTiledPixmap(
-            lua::get<const QRectF&>(state, 2),
-            lua::get<const QPixmap&>(state, 3),
-            lua::get<const QPointF&>(state, 4)
-        );
-        return 0;
-    }
-    // void drawTiledPixmap(const QRectF & rectangle, const QPixmap & pixmap)
-    self->drawTiledPixmap(
-        lua::get<const QRectF&>(state, 2),
-        lua::get<const QPixmap&>(state, 3)
-    );
-    return 0;
-}
-
-int QPainter_eraseRect(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    if (lua::is_type<QRect>(state, 2)) {
-        // void    eraseRect ( const QRect & rectangle )
-        self->eraseRect(
-            lua::get<const QRect&>(state, 2)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QRectF>(state, 3)) {
-        // void    eraseRect ( const QRectF & rectangle )
-        self->eraseRect(
-            lua::get<const QRectF&>(state, 2)
-        );
-        return 0;
-    }
-
-    // void    eraseRect ( int x, int y, int width, int height )
-    self->eraseRect(
-        lua::get<int>(state, 2),
-        lua::get<int>(state, 3),
-        lua::get<int>(state, 4),
-        lua::get<int>(state, 5)
-    );
-    return 0;
-}
-
-int QPainter_fillRect(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    if (lua::is_type<QRect>(state, 2)) {
-        if (lua::is_type<QColor>(state, 3)) {
-            // void    fillRect ( const QRect & rectangle, const QColor & color )
-            self->fillRect(
-                lua::get<const QRect&>(state, 2),
-                lua::get<const QColor&>(state, 3)
-            );
-            return 0;
-        }
-
-        if (lua::is_type<QBrush>(state, 3)) {
-            // void    fillRect ( const QRect & rectangle, const QBrush & brush )
-            self->fillRect(
-                lua::get<const QRect&>(state, 2),
-                lua::get<const QBrush&>(state, 3)
-            );
-            return 0;
-        }
-
-        if (lua::is_type<Qt::GlobalColor>(state, 3)) {
-            // void    fillRect ( const QRectF & rectangle, Qt::GlobalColor color )
-            self->fillRect(
-                lua::get<const QRectF&>(state, 2),
-                lua::get<Qt::GlobalColor>(state, 3)
-            );
-            return 0;
-        }
-
-        // void    fillRect ( const QRect & rectangle, Qt::BrushStyle style )
-        self->fillRect(
-            lua::get<const QRect&>(state, 2),
-            lua::get<Qt::BrushStyle>(state, 3)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QRectF>(state, 2)) {
-        if (lua::is_type<QColor>(state, 3)) {
-            // void    fillRect ( const QRectF & rectangle, const QColor & color )
-            self->fillRect(
-                lua::get<const QRectF&>(state, 2),
-                lua::get<const QColor&>(state, 3)
-            );
-            return 0;
-        }
-        if (lua::is_type<Qt::GlobalColor>(state, 3)) {
-            // void    fillRect ( const QRectF & rectangle, Qt::GlobalColor color )
-            self->fillRect(
-                lua::get<const QRectF&>(state, 2),
-                lua::get<Qt::GlobalColor>(state, 3)
-            );
-            return 0;
-        }
-
-        // void    fillRect ( const QRectF & rectangle, Qt::BrushStyle style )
-        self->fillRect(
-            lua::get<const QRectF&>(state, 2),
-            lua::get<Qt::BrushStyle>(state, 3)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QBrush>(state, 6)) {
-        // void    fillRect ( int x, int y, int width, int height, const QBrush & brush )
-        self->fillRect(
-            lua::get<int>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<int>(state, 4),
-            lua::get<int>(state, 5),
-            lua::get<const QBrush&>(state, 6)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QColor>(state, 6)) {
-        // void    fillRect ( int x, int y, int width, int height, const QColor & color )
-        self->fillRect(
-            lua::get<int>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<int>(state, 4),
-            lua::get<int>(state, 5),
-            lua::get<const QColor&>(state, 6)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<Qt::GlobalColor>(state, 6)) {
-        // void    fillRect ( int x, int y, int width, int height, Qt::BrushStyle style )
-        self->fillRect(
-            lua::get<int>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<int>(state, 4),
-            lua::get<int>(state, 5),
-            lua::get<Qt::BrushStyle>(state, 6)
-        );
-        return 0;
-    }
-
-    self->fillRect(
-        lua::get<int>(state, 2),
-        lua::get<int>(state, 3),
-        lua::get<int>(state, 4),
-        lua::get<int>(state, 5),
-        lua::get<Qt::GlobalColor>(state, 6)
-    );
-    return 0;
-}
-
-int QPainter_setBrush(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-    if (lua::is_type<QBrush>(state, 2)) {
-        // void setBrush(const QBrush & brush)
-        self->setBrush(lua::get<const QBrush&>(state, 2));
-        return 0;
-    }
-    self->setBrush(lua::get<Qt::BrushStyle>(state, 2));
-    return 0;
-}
-
-int QPainter_setBrushOrigin(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-    if (lua_gettop(state) == 2) {
-        if (lua::is_type<QPointF>(state, 2)) {
-            // void setBrushOrigin(const QPointF & position)
-            self->setBrushOrigin(lua::get<const QPointF&>(state, 2));
-            return 0;
-        }
-        // void setBrushOrigin(const QPoint & position)
-        self->setBrushOrigin(lua::get<const QPoint&>(state, 2));
-        return 0;
-    }
-    // void setBrushOrigin(int x, int y)
-    self->setBrushOrigin(
-        lua::get<int>(state, 2),
-        lua::get<int>(state, 3)
-    );
-    return 0;
-}
-
-int QPainter_setClipPath(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-    if (lua_gettop(state) == 2) {
-        // void setClipPath(const QPainterPath & path)
-        self->setClipPath(
-            lua::get<const QPainterPath&>(state, 2)
-        );
-        return 0;
-    }
-
-    // void setClipPath(const QPainterPath & path, Qt::ClipOperation operation)
-    self->setClipPath(
-        lua::get<const QPainterPath&>(state, 2),
-        lua::get<Qt::ClipOperation>(state, 3)
-    );
-    return 0;
-}
-
-int QPainter_setClipRect(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    if (lua_gettop(state) == 5) {
-        // void setClipRect(int x, int y, int width, int height)
-        self->setClipRect(
-            lua::get<int>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<int>(state, 4),
-            lua::get<int>(state, 5)
-        );
-        return 0;
-    }
-    if (lua_gettop(state) == 6) {
-        // void setClipRect(int x, int y, int width, int height, Qt::ClipOperation operation)
-        self->setClipRect(
-            lua::get<int>(state, 2),
-            lua::get<int>(state, 3),
-            lua::get<int>(state, 4),
-            lua::get<int>(state, 5),
-            lua::get<Qt::ClipOperation>(state, 6)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QRectF>(state, 2)) {
-        if (lua_gettop(state) > 2) {
-            // void setClipRect(const QRectF & rectangle, Qt::ClipOperation operation)
-            self->setClipRect(
-                lua::get<const QRectF&>(state, 2),
-                lua::get<Qt::ClipOperation>(state, 3)
-            );
-            return 0;
-        }
-        // void setClipRect(const QRectF & rectangle)
-        self->setClipRect(
-            lua::get<const QRectF&>(state, 2)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QRect>(state, 2)) {
-        if (lua_gettop(state) > 2) {
-            // void setClipRect(const QRect & rectangle, Qt::ClipOperation operation)
-            self->setClipRect(
-                lua::get<const QRect&>(state, 2),
-                lua::get<Qt::ClipOperation>(state, 3)
-            );
-            return 0;
-        }
-        // void setClipRect(const QRect & rectangle)
-        self->setClipRect(
-            lua::get<const QRect&>(state, 2)
-        );
-        return 0;
-    }
-
-    return 0;
-}
-
-int QPainter_setClipRegion(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-    if (lua_gettop(state) == 2) {
-        // void setClipRegion(const QRegion & region)
-        self->setClipRegion(
-            lua::get<const QRegion&>(state, 2)
-        );
-        return 0;
-    }
-
-    // void setClipRegion(const QRegion & region, Qt::ClipOperation operation)
-    self->setClipRegion(
-        lua::get<const QRegion&>(state, 2),
-        lua::get<Qt::ClipOperation>(state, 3)
-    );
-    return 0;
-}
-
-int QPainter_setPen(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    if (lua::is_type<QPen>(state, 2)) {
-        // void setPen(const QPen & pen)
-        self->setPen(lua::get<const QPen&>(state, 2));
-        return 0;
-    }
-    if (lua::is_type<QColor>(state, 2)) {
-        // void setPen(const QColor & color)
-        self->setPen(lua::get<const QColor&>(state, 2));
-        return 0;
-    }
-    // void setPen(Qt::PenStyle style)
-    self->setPen(lua::get<Qt::PenStyle>(state, 2));
-    return 0;
-}
-
-int QPainter_setViewport(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    if (lua_gettop(state) == 2) {
-        // void setViewport(const QRect & rectangle)
-        self->setViewport(lua::get<const QRect&>(state, 2));
-        return 0;
-    }
-
-    // void setViewport(int x, int y, int width, int height)
-    self->setViewport(
-        lua::get<int>(state, 2),
-        lua::get<int>(state, 3),
-        lua::get<int>(state, 4),
-        lua::get<int>(state, 5)
-    );
-    return 0;
-}
-
-int QPainter_setWindow(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    if (lua_gettop(state) == 2) {
-        // void setWindow(const QRect & rectangle)
-        self->setWindow(lua::get<const QRect&>(state, 2));
-        return 0;
-    }
-
-    // void setWindow(int x, int y, int width, int height)
-    self->setWindow(
-        lua::get<int>(state, 2),
-        lua::get<int>(state, 3),
-        lua::get<int>(state, 4),
-        lua::get<int>(state, 5)
-    );
-    return 0;
-}
-
-int QPainter_translate(lua_State* const state)
-{
-    auto self = lua::get<QPainter*>(state, 1);
-
-    if (lua_gettop(state) > 2) {
-        // void translate(qreal dx, qreal dy)
-        self->translate(
-            lua::get<qreal>(state, 2),
-            lua::get<qreal>(state, 3)
-        );
-        return 0;
-    }
-
-    if (lua::is_type<QPointF>(state, 2)) {
-        // void translate(const QPointF & offset)
-        self->translate(lua::get<const QPointF&>(state, 2));
-        return 0;
-    }
-
-    if (lua::is_type<QPoint>(state, 2)) {
-        // void translate(const QPoint& offset)
-        self->translate(lua::get<const QPoint&>(state, 2));
-        return 0;
-    }
-
-    return 0;
-}
-
 void lua::QPainter_metatable(const lua::index& mt)
 {
     mt["background"] = &QPainter::background;
     mt["backgroundMode"] = &QPainter::backgroundMode;
     mt["begin"] = &QPainter::begin;
     mt["beginNativePainting"] = &QPainter::beginNativePainting;
-    mt["boundingRect"] = QPainter_boundingRect;
+    mt["boundingRect"] = lua::overload()
+        .add<QRectF(QPainter::*)(const QRectF&, int, const QString&)>(&QPainter::boundingRect)
+        .add<QRect(QPainter::*)(const QRect&, int, const QString&)>(&QPainter::boundingRect)
+        .add<QRect(QPainter::*)(int, int, int, int, int, const QString&)>(&QPainter::boundingRect)
+        .add<QRectF(QPainter::*)(const QRectF&, const QString&, const QTextOption&)>(&QPainter::boundingRect)
+        .add(std::function<QRectF(QPainter*, const QRectF&, const QString&)>(
+            [](QPainter* self, const QRectF& rectangle, const QString& text) {
+                return self->boundingRect(rectangle, text);
+            }
+        ));
     mt["brush"] = &QPainter::brush;
     mt["brushOrigin"] = &QPainter::brushOrigin;
     mt["clipBoundingRect"] = &QPainter::clipBoundingRect;
@@ -1630,35 +473,199 @@ void lua::QPainter_metatable(const lua::index& mt)
     mt["compositionMode"] = &QPainter::compositionMode;
     mt["device"] = &QPainter::device;
     mt["deviceTransform"] = &QPainter::deviceTransform;
-    mt["drawArc"] = QPainter_drawArc;
-    mt["drawChord"] = QPainter_drawChord;
+    mt["drawArc"] = lua::overload()
+        .add<void(QPainter::*)(const QRectF&, int, int)>(&QPainter::drawArc)
+        .add<void(QPainter::*)(const QRect&, int, int)>(&QPainter::drawArc)
+        .add<void(QPainter::*)(int, int, int, int, int, int)>(&QPainter::drawArc);
+    mt["drawChord"] = lua::overload()
+        .add<void(QPainter::*)(const QRectF&, int, int)>(&QPainter::drawChord)
+        .add<void(QPainter::*)(const QRect&, int, int)>(&QPainter::drawChord)
+        .add<void(QPainter::*)(int, int, int, int, int, int)>(&QPainter::drawChord);
     mt["drawConvexPolygon"] = QPainter_drawConvexPolygon;
-    mt["drawEllipse"] = QPainter_drawEllipse;
+    mt["drawEllipse"] = lua::overload()
+        .add<void(QPainter::*)(const QRectF&)>(&QPainter::drawEllipse)
+        .add<void(QPainter::*)(const QRect&)>(&QPainter::drawEllipse)
+        .add<void(QPainter::*)(int, int, int, int)>(&QPainter::drawEllipse)
+        .add<void(QPainter::*)(const QPointF&, qreal, qreal)>(&QPainter::drawEllipse)
+        .add<void(QPainter::*)(const QPoint&, int, int)>(&QPainter::drawEllipse);
     mt["drawGlyphRun"] = &QPainter::drawGlyphRun;
-    mt["drawImage"] = QPainter_drawImage;
-    mt["drawLine"] = QPainter_drawLine;
+    mt["drawImage"] = lua::overload()
+        .add<void(QPainter::*)(const QRectF&, const QImage&)>(&QPainter::drawImage)
+        .add<void(QPainter::*)(const QRect&, const QImage&)>(&QPainter::drawImage)
+        .add<void(QPainter::*)(const QPointF&, const QImage&)>(&QPainter::drawImage)
+        .add<void(QPainter::*)(const QPoint&, const QImage&)>(&QPainter::drawImage)
+        .add(std::function<void(QPainter*, const QRectF&, const QImage&, const QRectF&)>(
+            [](QPainter* self, const QRectF& target, const QImage& image, const QRectF& source) {
+                self->drawImage(target, image, source);
+            }
+        ))
+        .add(std::function<void(QPainter*, const QRect&, const QImage&, const QRect&)>(
+            [](QPainter* self, const QRect& target, const QImage& image, const QRect& source) {
+                self->drawImage(target, image, source);
+            }
+        ))
+        .add(std::function<void(QPainter*, const QPointF&, const QImage&, const QRectF&)>(
+            [](QPainter* self, const QPointF& point, const QImage& image, const QRectF& source) {
+                self->drawImage(point, image, source);
+            }
+        ))
+        .add(std::function<void(QPainter*, const QPoint&, const QImage&, const QRect&)>(
+            [](QPainter* self, const QPoint& point, const QImage& image, const QRect& source) {
+                self->drawImage(point, image, source);
+            }
+        ))
+        .add<void(QPainter::*)(const QRectF&, const QImage&, const QRectF&, Qt::ImageConversionFlags)>(&QPainter::drawImage)
+        .add<void(QPainter::*)(const QRect&, const QImage&, const QRect&, Qt::ImageConversionFlags)>(&QPainter::drawImage)
+        .add<void(QPainter::*)(const QPointF&, const QImage&, const QRectF&, Qt::ImageConversionFlags)>(&QPainter::drawImage)
+        .add<void(QPainter::*)(const QPoint&, const QImage&, const QRect&, Qt::ImageConversionFlags)>(&QPainter::drawImage)
+        .add(std::function<void(QPainter*, int, int, const QImage&)>(
+            [](QPainter* self, int x, int y, const QImage& image) {
+                self->drawImage(x, y, image);
+            }
+        ))
+        .add(std::function<void(QPainter*, int, int, const QImage&, int, int, int, int)>(
+            [](QPainter* self, int x, int y, const QImage& image, int sx, int sy, int sw, int sh) {
+                self->drawImage(x, y, image, sx, sy, sw, sh);
+            }
+        ))
+        .add<void(QPainter::*)(int, int, const QImage&, int, int, int, int, Qt::ImageConversionFlags)>(&QPainter::drawImage);
+    mt["drawLine"] = lua::overload()
+        .add<void(QPainter::*)(const QLineF&)>(&QPainter::drawLine)
+        .add<void(QPainter::*)(const QLine&)>(&QPainter::drawLine)
+        .add<void(QPainter::*)(const QPointF&, const QPointF&)>(&QPainter::drawLine)
+        .add<void(QPainter::*)(const QPoint&, const QPoint&)>(&QPainter::drawLine)
+        .add<void(QPainter::*)(int, int, int, int)>(&QPainter::drawLine);
     mt["drawLines"] = QPainter_drawLines;
     mt["drawPath"] = &QPainter::drawPath;
-    mt["drawPicture"] = QPainter_drawPicture;
-    mt["drawPie"] = QPainter_drawPie;
-    mt["drawPixmap"] = QPainter_drawPixmap;
+    mt["drawPicture"] = lua::overload()
+        .add<void(QPainter::*)(const QPointF&, const QPicture&)>(&QPainter::drawPicture)
+        .add<void(QPainter::*)(const QPoint&, const QPicture&)>(&QPainter::drawPicture)
+        .add<void(QPainter::*)(int, int, const QPicture&)>(&QPainter::drawPicture);
+    mt["drawPie"] = lua::overload()
+        .add<void(QPainter::*)(const QRectF&, int, int)>(&QPainter::drawPie)
+        .add<void(QPainter::*)(const QRect&, int, int)>(&QPainter::drawPie)
+        .add<void(QPainter::*)(int, int, int, int, int, int)>(&QPainter::drawPie);
+    mt["drawPixmap"] = lua::overload()
+        .add<void(QPainter::*)(const QRectF&, const QPixmap&, const QRectF&)>(&QPainter::drawPixmap)
+        .add<void(QPainter::*)(const QRect&, const QPixmap&, const QRect&)>(&QPainter::drawPixmap)
+        .add<void(QPainter::*)(const QPointF&, const QPixmap&, const QRectF&)>(&QPainter::drawPixmap)
+        .add<void(QPainter::*)(const QPoint&, const QPixmap&, const QRect&)>(&QPainter::drawPixmap)
+        .add<void(QPainter::*)(const QPointF&, const QPixmap&)>(&QPainter::drawPixmap)
+        .add<void(QPainter::*)(const QPoint&, const QPixmap&)>(&QPainter::drawPixmap)
+        .add<void(QPainter::*)(const QRect&, const QPixmap&)>(&QPainter::drawPixmap)
+        .add<void(QPainter::*)(int, int, const QPixmap&)>(&QPainter::drawPixmap)
+        .add<void(QPainter::*)(int, int, int, int, const QPixmap&)>(&QPainter::drawPixmap)
+        .add<void(QPainter::*)(int, int, const QPixmap&, int, int, int, int)>(&QPainter::drawPixmap)
+        .add<void(QPainter::*)(int, int, int, int, const QPixmap&, int, int, int, int)>(&QPainter::drawPixmap);
     mt["drawPixmapFragments"] = &QPainter::drawPixmapFragments;
-    mt["drawPoint"] = QPainter_drawPoint;
+    mt["drawPoint"] = lua::overload()
+        .add<void(QPainter::*)(const QPointF&)>(&QPainter::drawPoint)
+        .add<void(QPainter::*)(const QPoint&)>(&QPainter::drawPoint)
+        .add<void(QPainter::*)(int, int)>(&QPainter::drawPoint);
     mt["drawPoints"] = QPainter_drawPoints;
     mt["drawPolygon"] = QPainter_drawPolygon;
     mt["drawPolyline"] = QPainter_drawPolyline;
-    mt["drawRect"] = QPainter_drawRect;
+    mt["drawRect"] = lua::overload()
+        .add<void(QPainter::*)(const QRectF&)>(&QPainter::drawRect)
+        .add<void(QPainter::*)(const QRect&)>(&QPainter::drawRect)
+        .add<void(QPainter::*)(int, int, int, int)>(&QPainter::drawRect);
     mt["drawRects"] = QPainter_drawRects;
-    mt["drawRoundedRect"] = QPainter_drawRoundedRect;
-    mt["drawStaticText"] = QPainter_drawStaticText;
-    mt["drawText"] = QPainter_drawText;
-    mt["drawTiledPixmap"] = QPainter_drawTiledPixmap;
+    mt["drawRoundedRect"] = lua::overload()
+        .add(std::function<void(QPainter*, const QRectF&, qreal, qreal)>(
+            [](QPainter* self, const QRectF& rect, qreal xRadius, qreal yRadius) {
+                self->drawRoundedRect(rect, xRadius, yRadius);
+            }
+        ))
+        .add(std::function<void(QPainter*, const QRect&, qreal, qreal)>(
+            [](QPainter* self, const QRect& rect, qreal xRadius, qreal yRadius) {
+                self->drawRoundedRect(rect, xRadius, yRadius);
+            }
+        ))
+        .add(std::function<void(QPainter*, int, int, int, int, qreal, qreal)>(
+            [](QPainter* self, int x, int y, int w, int h, qreal xRadius, qreal yRadius) {
+                self->drawRoundedRect(x, y, w, h, xRadius, yRadius);
+            }
+        ))
+        .add<void(QPainter::*)(const QRectF&, qreal, qreal, Qt::SizeMode)>(&QPainter::drawRoundedRect)
+        .add<void(QPainter::*)(const QRect&, qreal, qreal, Qt::SizeMode)>(&QPainter::drawRoundedRect)
+        .add<void(QPainter::*)(int, int, int, int, qreal, qreal, Qt::SizeMode)>(&QPainter::drawRoundedRect);
+    mt["drawStaticText"] = lua::overload()
+        .add<void(QPainter::*)(const QPointF&, const QStaticText&)>(&QPainter::drawStaticText)
+        .add<void(QPainter::*)(const QPoint&, const QStaticText&)>(&QPainter::drawStaticText)
+        .add<void(QPainter::*)(int, int, const QStaticText&)>(&QPainter::drawStaticText);
+    mt["drawText"] = lua::overload()
+        .add<void(QPainter::*)(const QPointF&, const QString&)>(&QPainter::drawText)
+        .add<void(QPainter::*)(const QPoint&, const QString&)>(&QPainter::drawText)
+        .add(std::function<void(QPainter*, const QRectF&, const QString&)>(
+            [](QPainter* self, const QRectF& rectangle, const QString& text) {
+                self->drawText(rectangle, text);
+            }
+        ))
+        .add<void(QPainter::*)(int, int, const QString&)>(&QPainter::drawText)
+        .add(std::function<void(QPainter*, const QRectF&, int, const QString&)>(
+            [](QPainter* self, const QRectF& rectangle, int flags, const QString& text) {
+                self->drawText(rectangle, flags, text);
+            }
+        ))
+        .add(std::function<void(QPainter*, const QRect&, int, const QString&)>(
+            [](QPainter* self, const QRect& rectangle, int flags, const QString& text) {
+                self->drawText(rectangle, flags, text);
+            }
+        ))
+        .add<void(QPainter::*)(const QRectF&, const QString&, const QTextOption&)>(&QPainter::drawText)
+        .add<void(QPainter::*)(const QRectF&, int, const QString&, QRectF*)>(&QPainter::drawText)
+        .add<void(QPainter::*)(const QRect&, int, const QString&, QRect*)>(&QPainter::drawText)
+        .add(std::function<void(QPainter*, int, int, int, int, int, const QString&)>(
+            [](QPainter* self, int x, int y, int width, int height, int flags, const QString& text) {
+                self->drawText(x, y, width, height, flags, text);
+            }
+        ))
+        .add<void(QPainter::*)(int, int, int, int, int, const QString&, QRect*)>(&QPainter::drawText);
+    mt["drawTiledPixmap"] = lua::overload()
+        .add(std::function<void(QPainter*, const QRectF&, const QPixmap&)>(
+            [](QPainter* self, const QRectF& rectangle, const QPixmap& pixmap) {
+                self->drawTiledPixmap(rectangle, pixmap);
+            }
+        ))
+        .add(std::function<void(QPainter*, const QRect&, const QPixmap&)>(
+            [](QPainter* self, const QRect& rectangle, const QPixmap& pixmap) {
+                self->drawTiledPixmap(rectangle, pixmap);
+            }
+        ))
+        .add<void(QPainter::*)(const QRectF&, const QPixmap&, const QPointF&)>(&QPainter::drawTiledPixmap)
+        .add<void(QPainter::*)(const QRect&, const QPixmap&, const QPoint&)>(&QPainter::drawTiledPixmap)
+        .add(std::function<void(QPainter*, int, int, int, int, const QPixmap&)>(
+            [](QPainter* self, int x, int y, int width, int height, const QPixmap& pixmap) {
+                self->drawTiledPixmap(x, y, width, height, pixmap);
+            }
+        ))
+        .add(std::function<void(QPainter*, int, int, int, int, const QPixmap&, int)>(
+            [](QPainter* self, int x, int y, int width, int height, const QPixmap& pixmap, int sx) {
+                self->drawTiledPixmap(x, y, width, height, pixmap, sx);
+            }
+        ))
+        .add<void(QPainter::*)(int, int, int, int, const QPixmap&, int, int)>(&QPainter::drawTiledPixmap);
     mt["end"] = &QPainter::end;
     mt["endPainting"] = &QPainter::end;
     mt["endNativePainting"] = &QPainter::endNativePainting;
-    mt["eraseRect"] = QPainter_eraseRect;
+    mt["eraseRect"] = lua::overload()
+        .add<void(QPainter::*)(const QRectF&)>(&QPainter::eraseRect)
+        .add<void(QPainter::*)(const QRect&)>(&QPainter::eraseRect)
+        .add<void(QPainter::*)(int, int, int, int)>(&QPainter::eraseRect);
     mt["fillPath"] = &QPainter::fillPath;
-    mt["fillRect"] = QPainter_fillRect;
+    mt["fillRect"] = lua::overload()
+        .add<void(QPainter::*)(const QRectF&, const QBrush&)>(&QPainter::fillRect)
+        .add<void(QPainter::*)(const QRectF&, const QColor&)>(&QPainter::fillRect)
+        .add<void(QPainter::*)(const QRectF&, Qt::GlobalColor)>(&QPainter::fillRect)
+        .add<void(QPainter::*)(const QRectF&, Qt::BrushStyle)>(&QPainter::fillRect)
+        .add<void(QPainter::*)(const QRect&, const QBrush&)>(&QPainter::fillRect)
+        .add<void(QPainter::*)(const QRect&, const QColor&)>(&QPainter::fillRect)
+        .add<void(QPainter::*)(const QRect&, Qt::GlobalColor)>(&QPainter::fillRect)
+        .add<void(QPainter::*)(const QRect&, Qt::BrushStyle)>(&QPainter::fillRect)
+        .add<void(QPainter::*)(int, int, int, int, const QBrush&)>(&QPainter::fillRect)
+        .add<void(QPainter::*)(int, int, int, int, const QColor&)>(&QPainter::fillRect)
+        .add<void(QPainter::*)(int, int, int, int, Qt::GlobalColor)>(&QPainter::fillRect)
+        .add<void(QPainter::*)(int, int, int, int, Qt::BrushStyle)>(&QPainter::fillRect);
     mt["font"] = &QPainter::font;
     mt["fontInfo"] = &QPainter::fontInfo;
     mt["fontMetrics"] = &QPainter::fontMetrics;
@@ -1677,30 +684,75 @@ void lua::QPainter_metatable(const lua::index& mt)
     mt["scale"] = &QPainter::scale;
     mt["setBackground"] = &QPainter::setBackground;
     mt["setBackgroundMode"] = &QPainter::setBackgroundMode;
-    mt["setBrush"] = QPainter_setBrush;
-    mt["setBrushOrigin"] = QPainter_setBrushOrigin;
-    mt["setClipPath"] = QPainter_setClipPath;
-    mt["setClipRect"] = QPainter_setClipRect;
-    mt["setClipRegion"] = QPainter_setClipRegion;
+    mt["setBrush"] = lua::overload()
+        .add<void(QPainter::*)(const QBrush&)>(&QPainter::setBrush)
+        .add<void(QPainter::*)(Qt::BrushStyle)>(&QPainter::setBrush);
+    mt["setBrushOrigin"] = lua::overload()
+        .add<void(QPainter::*)(const QPointF&)>(&QPainter::setBrushOrigin)
+        .add<void(QPainter::*)(const QPoint&)>(&QPainter::setBrushOrigin)
+        .add<void(QPainter::*)(int, int)>(&QPainter::setBrushOrigin);
+    mt["setClipPath"] = lua::overload()
+        .add(std::function<void(QPainter*, const QPainterPath&)>(
+            [](QPainter* self, const QPainterPath& path) {
+                self->setClipPath(path);
+            }
+        ))
+        .add<void(QPainter::*)(const QPainterPath&, Qt::ClipOperation)>(&QPainter::setClipPath);
+    mt["setClipRect"] = lua::overload()
+        .add(std::function<void(QPainter*, const QRectF&)>(
+            [](QPainter* self, const QRectF& rectangle) {
+                self->setClipRect(rectangle);
+            }
+        ))
+        .add(std::function<void(QPainter*, const QRect&)>(
+            [](QPainter* self, const QRect& rectangle) {
+                self->setClipRect(rectangle);
+            }
+        ))
+        .add<void(QPainter::*)(const QRectF&, Qt::ClipOperation)>(&QPainter::setClipRect)
+        .add<void(QPainter::*)(const QRect&, Qt::ClipOperation)>(&QPainter::setClipRect)
+        .add(std::function<void(QPainter*, int, int, int, int)>(
+            [](QPainter* self, int x, int y, int width, int height) {
+                self->setClipRect(x, y, width, height);
+            }
+        ))
+        .add<void(QPainter::*)(int, int, int, int, Qt::ClipOperation)>(&QPainter::setClipRect);
+    mt["setClipRegion"] = lua::overload()
+        .add(std::function<void(QPainter*, const QRegion&)>(
+            [](QPainter* self, const QRegion& region) {
+                self->setClipRegion(region);
+            }
+        ))
+        .add<void(QPainter::*)(const QRegion&, Qt::ClipOperation)>(&QPainter::setClipRegion);
     mt["setClipping"] = &QPainter::setClipping;
     mt["setCompositionMode"] = &QPainter::setCompositionMode;
     mt["setFont"] = &QPainter::setFont;
     mt["setLayoutDirection"] = &QPainter::setLayoutDirection;
     mt["setOpacity"] = &QPainter::setOpacity;
-    mt["setPen"] = QPainter_setPen;
+    mt["setPen"] = lua::overload()
+        .add<void(QPainter::*)(const QPen&)>(&QPainter::setPen)
+        .add<void(QPainter::*)(const QColor&)>(&QPainter::setPen)
+        .add<void(QPainter::*)(Qt::PenStyle)>(&QPainter::setPen);
     mt["setRenderHint"] = &QPainter::setRenderHint;
     mt["setRenderHints"] = &QPainter::setRenderHints;
     mt["setTransform"] = &QPainter::setTransform;
     mt["setViewTransformEnabled"] = &QPainter::setViewTransformEnabled;
-    mt["setViewport"] = QPainter_setViewport;
-    mt["setWindow"] = QPainter_setWindow;
+    mt["setViewport"] = lua::overload()
+        .add<void(QPainter::*)(const QRect&)>(&QPainter::setViewport)
+        .add<void(QPainter::*)(int, int, int, int)>(&QPainter::setViewport);
+    mt["setWindow"] = lua::overload()
+        .add<void(QPainter::*)(const QRect&)>(&QPainter::setWindow)
+        .add<void(QPainter::*)(int, int, int, int)>(&QPainter::setWindow);
     mt["setWorldMatrixEnabled"] = &QPainter::setWorldMatrixEnabled;
     mt["setWorldTransform"] = &QPainter::setWorldTransform;
     mt["shear"] = &QPainter::shear;
     mt["strokePath"] = &QPainter::strokePath;
     mt["testRenderHint"] = &QPainter::testRenderHint;
     mt["transform"] = &QPainter::transform;
-    mt["translate"] = QPainter_translate;
+    mt["translate"] = lua::overload()
+        .add<void(QPainter::*)(const QPointF&)>(&QPainter::translate)
+        .add<void(QPainter::*)(const QPoint&)>(&QPainter::translate)
+        .add<void(QPainter::*)(qreal, qreal)>(&QPainter::translate);
     mt["viewTransformEnabled"] = &QPainter::viewTransformEnabled;
     mt["viewport"] = &QPainter::viewport;
     mt["window"] = &QPainter::window;
@@ -187,7 +187,7 @@ int luaopen_Qt5Gui_QPalette(lua_State* const state)
     lua::thread env(state);
 
     env["QPalette"] = lua::value::table;
-    auto t = env["QPalette"];
+    lua::pinned t(env["QPalette"]);
 
     t["new"] = QPalette_new;
 
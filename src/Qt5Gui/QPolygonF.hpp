@@ -0,0 +1,20 @@
+#ifndef LUACXX_QPOLYGONF_INCLUDED
+#define LUACXX_QPOLYGONF_INCLUDED
+
+#include "../stack.hpp"
+#include "../sequence_view.hpp"
+#include "../Qt5Core/QPointF.hpp"
+#include "../Qt5Core/QVector.hpp"
+
+#include <QPolygonF>
+
+// http://qt-project.org/doc/qt-5/qpolygonf.html
+//
+// Polygons are passed as tables of QPointF, or as a lua::sequence_view of the
+// polygon itself. Include this wherever a QPolygonF or std::vector<QPointF> is
+// viewed, so each view has the same class name.
+
+LUACXX_SEQUENCE_VIEW_NAME(QPolygonF)
+LUACXX_SEQUENCE_VIEW_NAME(std::vector<QPointF>)
+
+#endif // LUACXX_QPOLYGONF_INCLUDED
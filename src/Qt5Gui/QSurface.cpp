@@ -22,7 +22,7 @@ int luaopen_Qt5Gui_QTcpSocket(lua_State* const state)
     lua::thread env(state);
 
     env["QSurface"] = lua::value::table;
-    auto t = env["QSurface"];
+    lua::pinned t(env["QSurface"]);
 
     // enum QSurface::SurfaceClass
     t["Window"] = QSurface::Window;
@@ -113,7 +113,7 @@ int luaopen_Qt5Gui_QSurfaceFormat(lua_State* const state)
 
     env["QSurfaceFormat"] = lua::value::table;
     env["QSurfaceFormat"]["new"] = QSurfaceFormat_new;
-    auto t = env["QSurfaceFormat"];
+    lua::pinned t(env["QSurfaceFormat"]);
 
     // enum QSurfaceFormat::FormatOption
     // flags QSurfaceFormat::FormatOptions
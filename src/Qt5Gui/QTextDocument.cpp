@@ -119,7 +119,7 @@ int luaopen_Qt5Gui_QTextDocument(lua_State* const state)
 
     env["QTextDocument"] = lua::value::table;
     env["QTextDocument"]["new"] = QTextDocument_new;
-    auto t = env["QTextDocument"];
+    lua::pinned t(env["QTextDocument"]);
 
     // enum QTextDocument::FindFlag
     // flags QTextDocument::FindFlags
@@ -180,7 +180,7 @@ int luaopen_Qt5Gui_QWindow(lua_State* const state)
 
     env["QWindow"] = lua::value::table;
     env["QWindow"]["new"] = QWindow_new;
-    auto t = env["QWindow"];
+    lua::pinned t(env["QWindow"]);
 
     env["fromWinId"] = &QWindow::fromWinId;
 
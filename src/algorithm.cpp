@@ -5,7 +5,9 @@
 #include "convert/numeric.hpp"
 #include "convert/callable.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <string>
 #include <sstream>
 
@@ -20,30 +22,60 @@ static int on_error(lua_State* const state)
     } else {
         lua::push(state, lua::error("An unspecified runtime error occurred during the execution of Lua code"));
     }
-    auto ex = lua::get<lua::error*>(state, 1);
-    ex->set_traceback(lua::traceback(state, 2));
+    if (lua::capturing_tracebacks(state)) {
+        auto ex = lua::get<lua::error*>(state, 1);
+        ex->set_traceback(lua::stack_frames(state, 2));
+    }
 
     return 1;
 }
 
-void lua::invoke(const lua::index& callable)
-{
-    auto state = callable.state();
-    int nargs = lua::top(callable.state()).pos() - callable.pos();
+namespace {
 
-    lua::assert_type("invoke", lua::type::function, callable);
+// The registry key of each state's traceback switch, which is only set when
+// tracebacks are disabled.
+char capture_tracebacks_key = 0;
 
-    // Call Lua function. LUA_MULTRET ensures all arguments are returned
-    // Subtract one from the size to ignore the function itself and pass
-    // the correct number of arguments
-    lua::push(state, on_error);
-    lua_insert(state, callable.pos());
+// The levels kept from the top and bottom of deep stacks, like luaL_traceback
+const int first_levels = 12;
+const int last_levels = 11;
 
-    int result = lua_pcall(state, nargs, LUA_MULTRET, callable.pos());
+// Finds the number of levels in the stack, by the same binary search as
+// luaL_traceback, since lua_getstack walks the stack from the top each time.
+int count_levels(lua_State* const state)
+{
+    lua_Debug ar;
+    int low = 1;
+    int high = 1;
+    while (lua_getstack(state, high, &ar)) {
+        low = high;
+        high *= 2;
+    }
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (lua_getstack(state, middle, &ar)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return high - 1;
+}
 
-    // Be sure to remove the error handler
-    lua_remove(state, callable.pos());
+void copy_text(char* const destination, const char* const source)
+{
+    if (!source) {
+        destination[0] = '\0';
+        return;
+    }
+    // Copy at most the text that fits, truncating long names
+    auto length = std::min(std::strlen(source), lua::stack_frame::text_size - 1);
+    std::memcpy(destination, source, length);
+    destination[length] = '\0';
+}
 
+void check_pcall_result(lua_State* const state, const int result)
+{
     switch (result) {
         case LUA_OK:
             return;
@@ -62,6 +94,47 @@ void lua::invoke(const lua::index& callable)
     throw std::logic_error(str.str());
 }
 
+} // namespace anonymous
+
+lua::index lua::push_error_handler(lua_State* const state)
+{
+    lua_pushcfunction(state, on_error);
+    return lua::index(state, -1);
+}
+
+void lua::invoke(const lua::index& callable)
+{
+    auto state = callable.state();
+    int nargs = lua::top(callable.state()).pos() - callable.pos();
+
+    lua::assert_type("invoke", lua::type::function, callable);
+
+    // Use the error handler below the callable, if it's already there
+    if (callable.pos() > 1 && lua_tocfunction(state, callable.pos() - 1) == on_error) {
+        check_pcall_result(state, lua_pcall(state, nargs, LUA_MULTRET, callable.pos() - 1));
+        return;
+    }
+
+    // Call Lua function. LUA_MULTRET ensures all arguments are returned
+    // Subtract one from the size to ignore the function itself and pass
+    // the correct number of arguments
+    lua::push(state, on_error);
+    lua_insert(state, callable.pos());
+
+    int result = lua_pcall(state, nargs, LUA_MULTRET, callable.pos());
+
+    // Be sure to remove the error handler
+    lua_remove(state, callable.pos());
+
+    check_pcall_result(state, result);
+}
+
+void lua::invoke_unprotected(const lua::index& callable)
+{
+    lua::assert_type("invoke_unprotected", lua::type::function, callable);
+    lua_call(callable.state(), lua_gettop(callable.state()) - callable.pos(), LUA_MULTRET);
+}
+
 std::string lua::traceback(lua_State* const state, const int toplevel)
 {
     #if LUA_VERSION_NUM >= 502
@@ -76,12 +149,72 @@ std::string lua::traceback(lua_State* const state, const int toplevel)
     #endif
 }
 
+std::vector<lua::stack_frame> lua::stack_frames(lua_State* const state, const int toplevel)
+{
+    std::vector<lua::stack_frame> rv;
+
+    lua_Debug ar;
+    int level = toplevel;
+    int last = count_levels(state);
+    bool skipping = last - toplevel > first_levels + last_levels;
+    while (lua_getstack(state, level, &ar)) {
+        if (skipping && level == toplevel + first_levels) {
+            lua::stack_frame gap = { "", "", 0, 0, '.', false };
+            rv.push_back(gap);
+            level = last - last_levels + 1;
+            continue;
+        }
+
+        lua_getinfo(state, "Slnt", &ar);
+
+        rv.emplace_back();
+        auto& frame = rv.back();
+        copy_text(frame.source, ar.short_src);
+        copy_text(frame.name, *ar.namewhat != '\0' ? ar.name : nullptr);
+        frame.line = ar.currentline;
+        frame.defined = ar.linedefined;
+        frame.what = *ar.what;
+        frame.tail_call = ar.istailcall;
+
+        ++level;
+    }
+
+    return rv;
+}
+
+void lua::capture_tracebacks(lua_State* const state, const bool enabled)
+{
+    if (enabled) {
+        lua_pushnil(state);
+    } else {
+        lua_pushboolean(state, false);
+    }
+    lua_rawsetp(state, LUA_REGISTRYINDEX, &capture_tracebacks_key);
+}
+
+bool lua::capturing_tracebacks(lua_State* const state)
+{
+    lua_rawgetp(state, LUA_REGISTRYINDEX, &capture_tracebacks_key);
+    bool rv = lua_isnil(state, -1);
+    lua_pop(state, 1);
+    return rv;
+}
+
 const char* lua::class_id(const lua::index& index)
 {
-    lua_getmetatable(index.state(), index.pos());
+    // Luacxx's userdata carry their type, so no lookups are needed.
+    auto userdata_block = lua::find_userdata_block(index.state(), index.pos());
+    if (userdata_block) {
+        auto type = userdata_block->type();
+        return type ? type->name : nullptr;
+    }
+
+    if (!lua_getmetatable(index.state(), index.pos())) {
+        return nullptr;
+    }
     lua_getfield(index.state(), -1, "__class");
     auto rv = lua_topointer(index.state(), -1);
-    lua_pop(index.state(), 1);
+    lua_pop(index.state(), 2);
     return static_cast<const char*>(rv);
 }
 
@@ -107,7 +240,7 @@ std::string lua::class_name(lua_State* const state, int pos)
 
 size_t lua::userdata_size(const lua::index& index)
 {
-    return lua_rawlen(index.state(), index.pos()) - sizeof(lua::userdata_block);
+    return lua_rawlen(index.state(), index.pos()) - lua::userdata_block_size;
 }
 
 std::string lua::dump(lua_State* const state)
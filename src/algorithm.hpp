@@ -39,6 +39,33 @@ std::string traceback(lua_State* const state, const int toplevel);
 
 /*
 
+=head4 std::vector<lua::stack_frame> frames = lua::stack_frames(state, int toplevel);
+
+Copies the state's call stack, from the given level, without formatting it.
+Like luaL_traceback, only the first 12 and last 11 levels of a deep stack are
+kept, with a gap between them. lua::invoke's error handler uses this to give
+each lua::error its traceback.
+
+=head4 lua::capture_tracebacks(state, bool enabled);
+
+Enables or disables capturing tracebacks for lua::errors raised within
+lua::invoke and lua::call on this state, which is enabled by default. Errors
+will still have their message, but no traceback, which saves copying the stack
+for handlers that fail often and don't report why.
+
+=head4 bool lua::capturing_tracebacks(state);
+
+Returns whether the state captures tracebacks for its errors.
+
+*/
+
+std::vector<lua::stack_frame> stack_frames(lua_State* const state, const int toplevel);
+
+void capture_tracebacks(lua_State* const state, const bool enabled);
+bool capturing_tracebacks(lua_State* const state);
+
+/*
+
 =head4 std::string str = lua::dump(state);
 
 Returns a diagnostic representation of the Lua stack
@@ -66,9 +93,9 @@ struct is_type
     const bool is_same;
 
     is_type(const lua::index& index) :
-        // Compare exactly for efficiency, but I really should
-        // benchmark this to ensure the performance is worth it.
-        is_same(lua::class_id(index) == required_name())
+        // Compare the type saved in the userdata, so no metatable lookups
+        // are needed.
+        is_same(check(lua::find_userdata_block(index.state(), index.pos())))
     {
     }
 
@@ -82,6 +109,11 @@ struct is_type
         return lua::Metatable<T>::name;
     }
 
+    static bool check(const lua::userdata_block* const userdata_block)
+    {
+        return userdata_block && userdata_block->type() == &lua::userdata_type_of<T>::value;
+    }
+
     operator bool() const
     {
         return is_same;
@@ -272,11 +304,49 @@ void invoke(const lua::index& callable);
 
 /*
 
+=head4 lua::index lua::push_error_handler(state)
+
+Pushes the error handler that lua::invoke uses to build lua::errors. If the
+value just below a callable is this handler, lua::invoke uses it as it is,
+rather than inserting a new one below the callable and removing it again
+afterwards, which moves every argument twice.
+
+Code that calls Lua often, such as a callback for each event, can push the
+handler once and keep it for several calls:
+
+    auto handler = lua::push_error_handler(state);
+    for (auto& event : events) {
+        lua::push(state, callback);
+        lua::push(state, event);
+        lua::invoke(lua::index(state, handler.pos() + 1));
+        lua_settop(state, handler.pos());
+    }
+    lua_pop(state, 1);
+
+lua::call does this for each call.
+
+=head4 lua::invoke_unprotected(lua::index callable)
+
+Like lua::invoke, but calls with lua_call, so there's no error handler at all.
+Errors are raised as Lua errors, to the nearest protected call, so this is only
+safe in code that's already within one, like a lua_CFunction, and where no C++
+objects with destructors would be skipped by the error.
+
+*/
+
+lua::index push_error_handler(lua_State* const state);
+
+void invoke_unprotected(const lua::index& callable);
+
+/*
+
 =head4 RV return_value = lua::call<RV>(source, args...)
 
 Invokes the given source value with the given arguments. The returned value
 will be converted and returned. The stack will be returned to its original
-state.
+state, apart from the first returned value, which is kept so the converted
+value stays valid. If the call fails, the stack is restored before the
+lua::error is thrown.
 
     #include <luacxx/convert/string.hpp>
     #include <luacxx/algorithm.hpp>
@@ -287,27 +357,44 @@ state.
     // HELLO, WORLD
 */
 
+// Restores the stack's top when it's destroyed, however a call finishes.
+struct restore_top
+{
+    lua_State* const state;
+    int top;
+
+    ~restore_top()
+    {
+        lua_settop(state, top);
+    }
+};
+
 template <typename RV, typename Callable, typename... Args>
 RV call(Callable source, Args... args)
 {
+    lua::restore_top restore = { source.state(), lua_gettop(source.state()) };
+    auto handler = lua::push_error_handler(source.state());
     lua::index callable(lua::push(source.state(), source));
     lua::assert_type("lua::call", lua::type::function, callable);
     lua::push(callable.state(), args...);
     lua::invoke(callable);
 
+    // Keep the first returned value, in place of the handler
     lua_settop(callable.state(), callable.pos());
-    return lua::get<RV>(callable.state(), callable.pos());
+    lua_replace(callable.state(), handler.pos());
+    restore.top = handler.pos();
+    return lua::get<RV>(callable.state(), handler.pos());
 }
 
 template <typename Callable, typename... Args>
 void call(Callable source, Args... args)
 {
+    lua::restore_top restore = { source.state(), lua_gettop(source.state()) };
+    lua::push_error_handler(source.state());
     lua::index callable(lua::push(source.state(), source));
     lua::assert_type("lua::call", lua::type::function, callable);
     lua::push(callable.state(), args...);
     lua::invoke(callable);
-
-    lua_settop(callable.state(), callable.pos() - 1);
 }
 
 template <class T>
@@ -0,0 +1,298 @@
+#include "allocator.hpp"
+
+#include "convert/callable.hpp"
+#include "convert/numeric.hpp"
+#include "table_builder.hpp"
+#include "thread.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+
+bool pooled(const size_t size)
+{
+    return size <= lua::pool_allocator::max_pooled_size;
+}
+
+size_t size_class(const size_t size)
+{
+    return (size + lua::pool_allocator::granularity - 1) / lua::pool_allocator::granularity - 1;
+}
+
+void* invoke_allocator(void* const ud, void* const ptr, const size_t osize, const size_t nsize)
+{
+    return static_cast<lua::allocator*>(ud)->reallocate(ptr, ptr ? osize : 0, nsize);
+}
+
+// Reports errors outside of a protected call, like luaL_newstate's own panic
+// function does.
+int panic(lua_State* const state)
+{
+    std::fprintf(stderr, "PANIC: unprotected error in call to Lua API (%s)\n",
+        lua_tostring(state, -1)
+    );
+    return 0;
+}
+
+int histogram_bucket(const size_t size)
+{
+    int bucket = 0;
+    while (bucket < lua::accounting_allocator::histogram_size - 1 && size > lua::accounting_allocator::histogram_bound(bucket)) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+lua::accounting_allocator& get_accounting(lua_State* const state)
+{
+    auto rv = lua::accounting(state);
+    if (!rv) {
+        throw lua::error("memory: This Lua state has no lua::accounting_allocator");
+    }
+    return *rv;
+}
+
+size_t memory_used(lua_State* const state)
+{
+    return get_accounting(state).used();
+}
+
+size_t memory_peak(lua_State* const state)
+{
+    return get_accounting(state).peak();
+}
+
+size_t memory_limit(lua_State* const state)
+{
+    return get_accounting(state).limit();
+}
+
+size_t memory_allocations(lua_State* const state)
+{
+    return get_accounting(state).allocations();
+}
+
+size_t memory_frees(lua_State* const state)
+{
+    return get_accounting(state).frees();
+}
+
+size_t memory_failures(lua_State* const state)
+{
+    return get_accounting(state).failures();
+}
+
+int memory_histogram(lua_State* const state)
+{
+    try {
+        auto& accounting = get_accounting(state);
+
+        const int last = lua::accounting_allocator::histogram_size - 1;
+        lua::table_builder histogram(state, 0, lua::accounting_allocator::histogram_size);
+        for (int i = 0; i < last; ++i) {
+            histogram.set(
+                static_cast<lua_Number>(lua::accounting_allocator::histogram_bound(i)),
+                accounting.histogram(i)
+            );
+        }
+        histogram.set(HUGE_VAL, accounting.histogram(last));
+        return 1;
+    } catch (lua::error& ex) {
+        lua::push(state, ex);
+        return lua_error(state);
+    }
+}
+
+} // namespace anonymous
+
+lua::pool_allocator::pool_allocator() :
+    _cursor(nullptr),
+    _end(nullptr)
+{
+    std::fill(_free, _free + num_classes, nullptr);
+}
+
+lua::pool_allocator::~pool_allocator()
+{
+    for (auto chunk : _chunks) {
+        std::free(chunk);
+    }
+}
+
+void* lua::pool_allocator::allocate(const size_t size)
+{
+    if (!pooled(size)) {
+        return std::malloc(size);
+    }
+
+    auto index = size_class(size);
+    if (_free[index]) {
+        auto block = _free[index];
+        _free[index] = block->next;
+        return block;
+    }
+
+    auto block_size = (index + 1) * granularity;
+    if (_cursor + block_size > _end) {
+        auto chunk = static_cast<char*>(std::malloc(chunk_size));
+        if (!chunk) {
+            return nullptr;
+        }
+        _chunks.push_back(chunk);
+        _cursor = chunk;
+        _end = chunk + chunk_size;
+    }
+
+    void* block = _cursor;
+    _cursor += block_size;
+    return block;
+}
+
+void lua::pool_allocator::release(void* const ptr, const size_t size)
+{
+    if (!ptr) {
+        return;
+    }
+    if (!pooled(size)) {
+        std::free(ptr);
+        return;
+    }
+
+    auto index = size_class(size);
+    auto block = static_cast<free_block*>(ptr);
+    block->next = _free[index];
+    _free[index] = block;
+}
+
+void* lua::pool_allocator::reallocate(void* const ptr, const size_t old_size, const size_t new_size)
+{
+    if (new_size == 0) {
+        release(ptr, old_size);
+        return nullptr;
+    }
+
+    if (ptr) {
+        if (pooled(old_size) && pooled(new_size) && size_class(old_size) == size_class(new_size)) {
+            // The block is already big enough
+            return ptr;
+        }
+        if (!pooled(old_size) && !pooled(new_size)) {
+            return std::realloc(ptr, new_size);
+        }
+    }
+
+    // Moving between the pool and malloc, or between size classes
+    auto rv = allocate(new_size);
+    if (!rv) {
+        return nullptr;
+    }
+    if (ptr) {
+        std::memcpy(rv, ptr, old_size < new_size ? old_size : new_size);
+        release(ptr, old_size);
+    }
+    return rv;
+}
+
+lua::accounting_allocator::accounting_allocator(const size_t limit, std::unique_ptr<allocator> base) :
+    _base(std::move(base)),
+    _limit(limit),
+    _used(0),
+    _peak(0),
+    _allocations(0),
+    _frees(0),
+    _failures(0)
+{
+    std::fill(_histogram, _histogram + histogram_size, 0);
+}
+
+void* lua::accounting_allocator::reallocate(void* const ptr, const size_t old_size, const size_t new_size)
+{
+    if (new_size == 0) {
+        if (ptr) {
+            _used -= old_size;
+            ++_frees;
+        }
+        if (_base) {
+            return _base->reallocate(ptr, old_size, 0);
+        }
+        std::free(ptr);
+        return nullptr;
+    }
+
+    if (_limit && new_size > old_size && _used - old_size + new_size > _limit) {
+        ++_failures;
+        return nullptr;
+    }
+
+    auto rv = _base ?
+        _base->reallocate(ptr, old_size, new_size) :
+        std::realloc(ptr, new_size);
+    if (!rv) {
+        ++_failures;
+        return nullptr;
+    }
+
+    if (!ptr) {
+        ++_allocations;
+    }
+    ++_histogram[histogram_bucket(new_size)];
+    _used = _used - old_size + new_size;
+    if (_used > _peak) {
+        _peak = _used;
+    }
+    return rv;
+}
+
+lua::accounting_allocator* lua::accounting(lua_State* const state)
+{
+    void* ud = nullptr;
+    if (lua_getallocf(state, &ud) != invoke_allocator) {
+        return nullptr;
+    }
+    return dynamic_cast<lua::accounting_allocator*>(static_cast<lua::allocator*>(ud));
+}
+
+lua_State* lua::newstate(std::unique_ptr<lua::allocator> allocator)
+{
+    auto state = lua_newstate(invoke_allocator, allocator.get());
+    if (!state) {
+        throw std::bad_alloc();
+    }
+    allocator.release();
+    lua_atpanic(state, panic);
+    return state;
+}
+
+void lua::close(lua_State* const state)
+{
+    void* ud = nullptr;
+    auto alloc = lua_getallocf(state, &ud);
+    lua_close(state);
+
+    if (alloc == invoke_allocator) {
+        delete static_cast<lua::allocator*>(ud);
+    }
+}
+
+int luaopen_luacxx_memory(lua_State* const state)
+{
+    lua::thread env(state);
+
+    env["memory"] = lua::value::table;
+    lua::pinned t(env["memory"]);
+
+    t["used"] = memory_used;
+    t["peak"] = memory_peak;
+    t["limit"] = memory_limit;
+    t["allocations"] = memory_allocations;
+    t["frees"] = memory_frees;
+    t["failures"] = memory_failures;
+    t["histogram"] = memory_histogram;
+
+    return 0;
+}
@@ -0,0 +1,237 @@
+#ifndef LUACXX_ALLOCATOR_INCLUDED
+#define LUACXX_ALLOCATOR_INCLUDED
+
+#include "stack.hpp"
+
+#include <memory>
+#include <vector>
+
+/*
+
+=head1 NAME
+
+lua::allocator - memory policies for new Lua states
+
+=head1 SYNOPSIS
+
+    #include <luacxx/thread.hpp>
+
+    // Use the default allocator, which is realloc
+    auto env = lua::create();
+
+    // Use a pool of small blocks, returned in bulk when the state is closed
+    auto pooled = lua::create(std::unique_ptr<lua::allocator>(new lua::pool_allocator));
+
+=head1 DESCRIPTION
+
+Lua allocates memory for every string, table, closure, and userdata, and most
+of those are small. With the default allocator, each of them is a separate
+malloc() and free(), which is slow for small blocks, and can fragment the heap
+of a long-running process.
+
+A lua::allocator can be given to lua::create() instead. The new state owns its
+allocator, which is deleted after the state is closed. This happens when the
+owning lua::thread is destroyed, or when lua::close() is called. A state closed
+with lua_close() directly will leak its allocator.
+
+=head4 lua::allocator
+
+The interface for allocators. Subclasses implement reallocate(), with the same
+contract as lua_Alloc: a new_size of zero frees ptr, a null ptr allocates, and
+old_size is only meaningful when ptr is not null. Returning nullptr reports
+that the memory is exhausted; allocators must not throw.
+
+=head4 lua::pool_allocator
+
+Serves blocks of up to max_pooled_size bytes from free lists, one per multiple
+of granularity bytes. Blocks come from chunks of chunk_size bytes, and freed
+blocks are reused by later allocations of the same size class. Larger blocks
+are given to malloc() as usual.
+
+Chunks are only returned when the allocator is deleted, all at once, so the
+process' heap is not fragmented by the state's small objects. Each allocator
+belongs to a single state, and Lua states are not used by several threads at
+once, so there's no locking: states on different threads never contend.
+
+=head4 lua::accounting_allocator(limit = 0, base = nullptr)
+
+Counts the memory used by its state, and optionally limits it. Allocations are
+passed to the base allocator, or to realloc() if there isn't one, so it can be
+combined with a pool_allocator:
+
+    auto env = lua::create(std::unique_ptr<lua::allocator>(
+        new lua::accounting_allocator(64 * 1024 * 1024,
+            std::unique_ptr<lua::allocator>(new lua::pool_allocator)
+        )
+    ));
+
+used() and peak() return the live and highest number of bytes, allocations()
+and frees() count blocks, and histogram() counts each requested size, in
+powers of two: bucket 0 is up to 16 bytes, bucket 1 up to 32, and so on, with
+everything larger than histogram_bound(histogram_size - 2) in the last bucket.
+
+With a non-zero limit(), any allocation that would take used() past the limit
+fails, and Lua raises a memory error, which lua::invoke and lua::load report
+as it does for any other LUA_ERRMEM. Shrinking and freeing never fail. The
+limit can be changed with set_limit(), and reset_peak() starts the high-water
+mark again from used().
+
+=head4 lua::accounting_allocator* lua::accounting(state)
+
+Returns the state's accounting_allocator, or nullptr if it was created without
+one.
+
+=head4 luaopen_luacxx_memory(state)
+
+Adds a memory table to Lua's globals, for the state's own accounting_allocator:
+
+    print(memory.used(), memory.peak(), memory.limit())
+    print(memory.allocations(), memory.frees(), memory.failures())
+    for bound, count in pairs(memory.histogram()) do print(bound, count) end
+
+The histogram is keyed by each bucket's upper bound, with math.huge for the
+last. Scripts can read the counters, but can't change the limit. Each function
+raises an error if the state has no accounting_allocator.
+
+=head4 void lua::close(state)
+
+Closes the state, and then deletes its lua::allocator, if it has one.
+
+*/
+
+namespace lua {
+
+class allocator
+{
+public:
+    virtual ~allocator()
+    {
+    }
+
+    virtual void* reallocate(void* const ptr, const size_t old_size, const size_t new_size) = 0;
+};
+
+class pool_allocator : public allocator
+{
+public:
+    static const size_t granularity = 16;
+    static const size_t max_pooled_size = 256;
+    static const size_t chunk_size = 64 * 1024;
+
+    pool_allocator();
+    ~pool_allocator();
+
+    pool_allocator(const pool_allocator&) = delete;
+    pool_allocator& operator=(const pool_allocator&) = delete;
+
+    void* reallocate(void* const ptr, const size_t old_size, const size_t new_size) override;
+
+private:
+    struct free_block
+    {
+        free_block* next;
+    };
+
+    static const size_t num_classes = max_pooled_size / granularity;
+
+    // The free list of each size class
+    free_block* _free[num_classes];
+
+    // Chunks that blocks are cut from, and the unused part of the last one
+    std::vector<void*> _chunks;
+    char* _cursor;
+    char* _end;
+
+    void* allocate(const size_t size);
+    void release(void* const ptr, const size_t size);
+};
+
+class accounting_allocator : public allocator
+{
+public:
+    static const int histogram_size = 16;
+
+    explicit accounting_allocator(const size_t limit = 0, std::unique_ptr<allocator> base = nullptr);
+
+    accounting_allocator(const accounting_allocator&) = delete;
+    accounting_allocator& operator=(const accounting_allocator&) = delete;
+
+    void* reallocate(void* const ptr, const size_t old_size, const size_t new_size) override;
+
+    size_t used() const
+    {
+        return _used;
+    }
+
+    size_t peak() const
+    {
+        return _peak;
+    }
+
+    size_t limit() const
+    {
+        return _limit;
+    }
+
+    // A limit of zero means there is none.
+    void set_limit(const size_t limit)
+    {
+        _limit = limit;
+    }
+
+    void reset_peak()
+    {
+        _peak = _used;
+    }
+
+    size_t allocations() const
+    {
+        return _allocations;
+    }
+
+    size_t frees() const
+    {
+        return _frees;
+    }
+
+    // The number of allocations refused because of the limit, or the base
+    // allocator.
+    size_t failures() const
+    {
+        return _failures;
+    }
+
+    size_t histogram(const int bucket) const
+    {
+        return _histogram[bucket];
+    }
+
+    // The largest size counted in the given bucket.
+    static size_t histogram_bound(const int bucket)
+    {
+        return static_cast<size_t>(16) << bucket;
+    }
+
+private:
+    std::unique_ptr<allocator> _base;
+    size_t _limit;
+    size_t _used;
+    size_t _peak;
+    size_t _allocations;
+    size_t _frees;
+    size_t _failures;
+    size_t _histogram[histogram_size];
+};
+
+accounting_allocator* accounting(lua_State* const state);
+
+// Creates a new state that uses, and owns, the given allocator.
+lua_State* newstate(std::unique_ptr<lua::allocator> allocator);
+
+void close(lua_State* const state);
+
+} // namespace lua
+
+extern "C" int luaopen_luacxx_memory(lua_State* const);
+
+#endif // LUACXX_ALLOCATOR_INCLUDED
@@ -0,0 +1,195 @@
+#ifndef LUACXX_BATCH_INCLUDED
+#define LUACXX_BATCH_INCLUDED
+
+#include "stack.hpp"
+#include "algorithm.hpp"
+#include "function.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <utility>
+
+/*
+
+=head1 NAME
+
+lua::for_each, lua::map - call a Lua function for each of many values
+
+=head1 SYNOPSIS
+
+    #include <luacxx/batch.hpp>
+    #include <luacxx/convert/numeric.hpp>
+    #include <luacxx/convert/vector.hpp>
+
+    std::vector<double> prices = load_prices();
+
+    // Collect each result into a container
+    auto taxed = lua::map<std::vector<double>>(env["add_tax"], prices);
+
+    // Or into a new Lua table, left on the stack
+    auto table = lua::map_table(env["add_tax"], prices);
+
+    // Or ignore the results
+    lua::for_each(env["log_price"], prices);
+
+    // Stack ranges can be given, too
+    int sum_squares(lua_State* const state)
+    {
+        auto squares = lua::map<std::vector<int>>(lua::index(state, 1), lua::range<int>(state));
+        ...
+    }
+
+=head1 DESCRIPTION
+
+Calling lua::call for each value sets up its error handler, finds the callable
+again, and tidies the stack afterwards, each time. These helpers do that once
+for the whole batch: the callable and lua::invoke's error handler are pushed
+once, and each call copies the callable from its slot, pushes one value, and
+converts its first result, if any, from the same stack position.
+
+Values are pushed with lua::push, so anything lua::push accepts can be given,
+in any range that works with a range-based for loop, including lua::range.
+The range's end is found before anything is pushed.
+
+The stack is restored once the batch is finished, even if a call fails, except
+for the table left by lua::map_table.
+
+=head4 lua::for_each(callable, values)
+
+Calls the callable once for each value, ignoring its results.
+
+=head4 Container lua::map<Container>(callable, values)
+
+Calls the callable once for each value, and adds its first result, converted to
+the container's value_type, to the end of the returned container.
+
+=head4 lua::index lua::map_table(callable, values)
+
+Calls the callable once for each value, and sets its first result at the same
+position in a new Lua table, starting from 1. The table is created with room
+for every value, if the range has a size(). Since nil results are not stored
+in the table, its length is only the number of values when every result is
+present.
+
+=head4 lua::batch_error
+
+Thrown when one of the calls fails. It's a lua::error, with the original
+message, prefixed by the failing value's position, and traceback. index()
+returns that position, counting from 0, in the order of the given range.
+
+*/
+
+namespace lua {
+
+class batch_error : public lua::error
+{
+    size_t _index;
+
+public:
+    batch_error(const lua::error& ex, const size_t index) :
+        lua::error(ex),
+        _index(index)
+    {
+        set_message("Error at element " + std::to_string(index) + ": " + ex.message());
+    }
+
+    size_t index() const
+    {
+        return _index;
+    }
+};
+
+template <class Range>
+auto batch_size(const Range& values, int) -> decltype(static_cast<size_t>(values.size()))
+{
+    return values.size();
+}
+
+template <class Range>
+size_t batch_size(const Range& values, long)
+{
+    return 0;
+}
+
+// Calls source for each value, giving each first result, and its position, to
+// the given receiver. Results are given as the stack index of a value that's
+// only valid during the receiver's call.
+//
+// The iterators are found before anything is pushed, since a lua::range's end
+// is the top of the stack. Positions start from first, so a slice of a larger
+// range can report positions within the whole range.
+template <class Callable, class Iterator, class Receiver>
+void batch_invoke(lua_State* const state, Callable&& source, Iterator iter, Iterator end, Receiver&& receiver, const size_t first = 0)
+{
+    lua::restore_top restore = { state, lua_gettop(state) };
+
+    auto callable = lua::push(state, std::forward<Callable>(source));
+    lua::assert_type("lua::batch_invoke", lua::type::function, callable);
+    auto handler = lua::push_error_handler(state);
+    lua::index call(state, handler.pos() + 1);
+
+    for (size_t index = first; iter != end; ++iter, ++index) {
+        lua_pushvalue(state, callable.pos());
+        lua::push(state, *iter);
+        try {
+            lua::invoke(call);
+        } catch (lua::error& ex) {
+            throw lua::batch_error(ex, index);
+        }
+
+        // Keep the first result, or nil if there wasn't one
+        lua_settop(state, call.pos());
+        receiver(call, index);
+        lua_settop(state, handler.pos());
+    }
+}
+
+template <class Callable, class Range>
+void for_each(Callable source, Range&& values)
+{
+    batch_invoke(source.state(), source, std::begin(values), std::end(values), [](const lua::index&, const size_t) {
+    });
+}
+
+template <class Container, class Callable, class Range>
+Container map(Callable source, Range&& values)
+{
+    typedef typename Container::value_type value_type;
+
+    Container rv;
+    batch_invoke(source.state(), source, std::begin(values), std::end(values), [&rv](const lua::index& result, const size_t) {
+        rv.push_back(lua::get<value_type>(result));
+    });
+    return rv;
+}
+
+template <class Callable, class Range>
+lua::index map_table(Callable source, Range&& values)
+{
+    auto state = source.state();
+    auto iter = std::begin(values);
+    auto end = std::end(values);
+    auto size = batch_size(values, 0);
+    if (size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        throw lua::error("lua::map_table: Too many values for a Lua table");
+    }
+    lua_createtable(state, static_cast<int>(size), 0);
+    lua::index table(state, -1);
+
+    try {
+        batch_invoke(state, source, iter, end, [&table](const lua::index& result, const size_t index) {
+            lua_pushvalue(result.state(), result.pos());
+            lua_rawseti(result.state(), table.pos(), static_cast<int>(index + 1));
+        });
+    } catch (...) {
+        lua_settop(state, table.pos() - 1);
+        throw;
+    }
+    return table;
+}
+
+} // namespace lua
+
+#endif // LUACXX_BATCH_INCLUDED
@@ -0,0 +1,545 @@
+#include "thread.hpp"
+#include "algorithm.hpp"
+#include "batch.hpp"
+#include "load.hpp"
+#include "convert/callable.hpp"
+#include "convert/numeric.hpp"
+#include "convert/vector.hpp"
+#include "convert/map.hpp"
+#include "overload.hpp"
+#include "key.hpp"
+#include "buffer.hpp"
+#include "sequence_view.hpp"
+#include "table_builder.hpp"
+#include "table_view.hpp"
+#include "function.hpp"
+#include "state_pool.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+
+/*
+
+=head1 NAME
+
+luacxx_benchmark - microbenchmarks for Luacxx's core paths
+
+=head1 SYNOPSIS
+
+    make luacxx_benchmark
+    ./luacxx_benchmark [runs]
+
+=head1 DESCRIPTION
+
+Each benchmark is run several times, and the time for each run is printed
+along with the throughput. Run this before and after a change to the core to
+see how it performs.
+
+*/
+
+namespace {
+
+struct BenchPoint
+{
+    double x;
+    double y;
+
+    BenchPoint(const double x, const double y) :
+        x(x),
+        y(y)
+    {
+    }
+
+    double dot(const double dx, const double dy) const
+    {
+        return x * dx + y * dy;
+    }
+};
+
+double bench_add(const double a, const double b)
+{
+    return a + b;
+}
+
+struct BenchLine
+{
+    double length;
+};
+
+struct BenchRect
+{
+    double width;
+};
+
+} // namespace anonymous
+
+namespace lua {
+
+template <>
+struct Metatable<BenchPoint>
+{
+    static constexpr const char* name = "BenchPoint";
+
+    static bool metatable(const lua::index& mt, BenchPoint* const)
+    {
+        return true;
+    }
+};
+
+template <>
+struct Metatable<BenchLine>
+{
+    static constexpr const char* name = "BenchLine";
+
+    static bool metatable(const lua::index& mt, BenchLine* const)
+    {
+        return true;
+    }
+};
+
+template <>
+struct Metatable<BenchRect>
+{
+    static constexpr const char* name = "BenchRect";
+
+    static bool metatable(const lua::index& mt, BenchRect* const)
+    {
+        return true;
+    }
+};
+
+} // namespace lua
+
+namespace {
+
+double bench_measure_line(const BenchLine& line)
+{
+    return line.length;
+}
+
+double bench_measure_rect(const BenchRect& rect)
+{
+    return rect.width;
+}
+
+double bench_measure_point(const BenchPoint& point)
+{
+    return point.x;
+}
+
+// Dispatches by hand, as bindings have done without lua::overload
+int bench_measure_by_hand(lua_State* const state)
+{
+    if (lua::is_type<BenchLine>(state, 1)) {
+        lua::push(state, bench_measure_line(lua::get<const BenchLine&>(state, 1)));
+        return 1;
+    }
+    if (lua::is_type<BenchRect>(state, 1)) {
+        lua::push(state, bench_measure_rect(lua::get<const BenchRect&>(state, 1)));
+        return 1;
+    }
+    lua::push(state, bench_measure_point(lua::get<const BenchPoint&>(state, 1)));
+    return 1;
+}
+
+void benchmark(const std::string& name, const long runs, const std::function<void(const long)>& body)
+{
+    std::printf("%s (runs=%ld)\n", name.c_str(), runs);
+    for (int i = 0; i < 3; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        body(runs);
+        auto elapsed = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start
+        ).count();
+        std::printf("    %.02fms (%.02f million per second)\n",
+            elapsed,
+            runs / elapsed / 1e3
+        );
+    }
+    std::printf("\n");
+}
+
+} // namespace anonymous
+
+int main(int argc, char** argv)
+{
+    long runs = 1000000;
+    if (argc > 1) {
+        runs = std::atol(argv[1]);
+    }
+
+    auto env = lua::create();
+
+    benchmark("push userdata by value", runs, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            lua::push(env, BenchPoint(i, i));
+            lua_pop(env, 1);
+        }
+        lua_gc(env, LUA_GCCOLLECT, 0);
+    });
+
+    benchmark("push cached metatable", runs, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            lua::push_metatable<BenchPoint>(env, nullptr);
+            lua_pop(env, 1);
+        }
+    });
+
+    BenchPoint point(2, 3);
+    benchmark("push userdata by pointer", runs, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            lua::push(env, &point);
+            lua_pop(env, 1);
+        }
+        lua_gc(env, LUA_GCCOLLECT, 0);
+    });
+
+    lua::push(env, BenchPoint(2, 3));
+    benchmark("check userdata type", runs, [&](const long runs) {
+        long matches = 0;
+        for (long i = 0; i < runs; ++i) {
+            if (lua::is_type<BenchPoint>(env, 1)) {
+                ++matches;
+            }
+        }
+        if (matches != runs) {
+            std::abort();
+        }
+    });
+
+    benchmark("get userdata pointer", runs, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            if (!lua::get<BenchPoint*>(env, 1)) {
+                std::abort();
+            }
+        }
+    });
+    lua::clear(env);
+
+    env["bench_add"] = bench_add;
+    env["bench_point"] = BenchPoint(2, 3);
+    env["bench_dot"] = &BenchPoint::dot;
+    benchmark("call free function from Lua", runs, [&](const long runs) {
+        lua::load_string(env,
+            "local bench_add, runs = bench_add, ...;"
+            "for i=1, runs do bench_add(i, i) end"
+        );
+        lua::call(lua::index(env, -1), runs);
+        lua::clear(env);
+    });
+
+    benchmark("call method from Lua", runs, [&](const long runs) {
+        lua::load_string(env,
+            "local bench_dot, bench_point, runs = bench_dot, bench_point, ...;"
+            "for i=1, runs do bench_dot(bench_point, i, i) end"
+        );
+        lua::call(lua::index(env, -1), runs);
+        lua::clear(env);
+    });
+
+    env["bench_measure_by_hand"] = bench_measure_by_hand;
+    env["bench_measure"] = lua::overload()
+        .add(bench_measure_line)
+        .add(bench_measure_rect)
+        .add(bench_measure_point);
+    benchmark("call overloaded function dispatched by hand", runs, [&](const long runs) {
+        lua::load_string(env,
+            "local bench_measure, bench_point, runs = bench_measure_by_hand, bench_point, ...;"
+            "for i=1, runs do bench_measure(bench_point) end"
+        );
+        lua::call(lua::index(env, -1), runs);
+        lua::clear(env);
+    });
+
+    benchmark("call overloaded function through lua::overload", runs, [&](const long runs) {
+        lua::load_string(env,
+            "local bench_measure, bench_point, runs = bench_measure, bench_point, ...;"
+            "for i=1, runs do bench_measure(bench_point) end"
+        );
+        lua::call(lua::index(env, -1), runs);
+        lua::clear(env);
+    });
+
+    lua::run_string(env, "bench_config = { width = 640 }");
+    benchmark("read global table field by name", runs, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            if (env["bench_config"]["width"].get<int>() != 640) {
+                std::abort();
+            }
+        }
+    });
+
+    lua::key bench_config(env, "bench_config");
+    lua::key width(env, "width");
+    benchmark("read global table field by lua::key", runs, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            if (env[bench_config][width].get<int>() != 640) {
+                std::abort();
+            }
+        }
+    });
+
+    lua::run_string(env, "bench_nested = { a = { b = { c = {} } } }");
+    benchmark("set nested table field by path", runs, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            env["bench_nested"]["a"]["b"]["c"]["value"] = i;
+        }
+    });
+
+    lua::pinned bench_nested(env["bench_nested"]["a"]["b"]["c"]);
+    benchmark("set nested table field through lua::pinned", runs, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            bench_nested["value"] = i;
+        }
+    });
+
+    // Each run converts a thousand elements
+    std::vector<double> bench_samples(1000);
+    for (size_t i = 0; i < bench_samples.size(); ++i) {
+        bench_samples[i] = i * 0.5;
+    }
+    benchmark("push std::vector<double> (per 1000 elements)", runs / 1000, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            lua::push(env, bench_samples);
+            lua_pop(env, 1);
+        }
+        lua_gc(env, LUA_GCCOLLECT, 0);
+    });
+
+    benchmark("push lua::sequence_view of std::vector<double> (1000 elements)", runs / 1000, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            lua::push(env, lua::view(&bench_samples));
+            lua_pop(env, 1);
+        }
+        lua_gc(env, LUA_GCCOLLECT, 0);
+    });
+
+    lua::push(env, bench_samples);
+    benchmark("store std::vector<double> (per 1000 elements)", runs / 1000, [&](const long runs) {
+        std::vector<double> destination;
+        for (long i = 0; i < runs; ++i) {
+            destination.clear();
+            lua::store(destination, lua::index(env, 1));
+        }
+    });
+
+    benchmark("sum a table through lua::table_view<double> (per 1000 elements)", runs / 1000, [&](const long runs) {
+        double sum = 0;
+        for (long i = 0; i < runs; ++i) {
+            for (auto value : lua::table_view<double>(lua::index(env, 1))) {
+                sum += value;
+            }
+        }
+        bench_samples[0] = sum > 0 ? 0 : 1;
+    });
+    lua::clear(env);
+
+    // Each run sums a thousand elements
+    luaopen_luacxx_buffer(env);
+    lua::run_string(env, "bench_table = {} for i = 1, 1000 do bench_table[i] = i * 0.5 end");
+    lua::run_string(env, "bench_buffer = buffer.double(bench_table)");
+    lua::clear(env);
+    benchmark("sum a table of numbers from Lua (per 1000 elements)", runs / 1000, [&](const long runs) {
+        std::string code = "local t = bench_table for _ = 1, " + std::to_string(runs)
+            + " do local sum = 0 for i = 1, #t do sum = sum + t[i] end end";
+        lua::run_string(env, code);
+    });
+
+    benchmark("sum a lua::buffer<double> from Lua (per 1000 elements)", runs / 1000, [&](const long runs) {
+        std::string code = "local b = bench_buffer for _ = 1, " + std::to_string(runs)
+            + " do local sum = b:sum() end";
+        lua::run_string(env, code);
+    });
+    lua::clear(env);
+
+
+    // Each run builds a table of a thousand entries
+    benchmark("fill a table with lua::table::set (per 1000 entries)", runs / 1000, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            auto table = lua::push(env, lua::value::table);
+            for (int j = 1; j <= 1000; ++j) {
+                lua::table::set(table, j, j);
+            }
+            lua_pop(env, 1);
+        }
+        lua_gc(env, LUA_GCCOLLECT, 0);
+    });
+
+    benchmark("fill a table with lua::table_builder (per 1000 entries)", runs / 1000, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            lua::table_builder table(env, 1000, 0);
+            for (int j = 1; j <= 1000; ++j) {
+                table.append(j);
+            }
+            lua_pop(env, 1);
+        }
+        lua_gc(env, LUA_GCCOLLECT, 0);
+    });
+
+    std::map<std::string, int> bench_map;
+    for (int i = 0; i < 1000; ++i) {
+        bench_map["key" + std::to_string(i)] = i;
+    }
+    benchmark("push std::map<std::string, int> (per 1000 entries)", runs / 1000, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            lua::push(env, bench_map);
+            lua_pop(env, 1);
+        }
+        lua_gc(env, LUA_GCCOLLECT, 0);
+    });
+
+
+    // Garbage-heavy work, in fresh states with each allocator
+    const char* const bench_garbage =
+        "local runs = ...\n"
+        "local keep = {}\n"
+        "for i = 1, runs do\n"
+        "    local t = { i, tostring(i), function() return i end }\n"
+        "    keep[i % 64 + 1] = t\n"
+        "end\n";
+    benchmark("allocate garbage with the default allocator", runs, [&](const long runs) {
+        auto garbage_env = lua::create();
+        luaL_loadstring(garbage_env, bench_garbage);
+        lua::push(garbage_env, runs);
+        lua_call(garbage_env, 1, 0);
+    });
+
+    benchmark("allocate garbage with lua::pool_allocator", runs, [&](const long runs) {
+        auto garbage_env = lua::create(std::unique_ptr<lua::allocator>(new lua::pool_allocator));
+        luaL_loadstring(garbage_env, bench_garbage);
+        lua::push(garbage_env, runs);
+        lua_call(garbage_env, 1, 0);
+    });
+
+    benchmark("allocate garbage with lua::accounting_allocator", runs, [&](const long runs) {
+        auto garbage_env = lua::create(std::unique_ptr<lua::allocator>(new lua::accounting_allocator));
+        luaL_loadstring(garbage_env, bench_garbage);
+        lua::push(garbage_env, runs);
+        lua_call(garbage_env, 1, 0);
+    });
+
+    // Calling Lua from C++, as for callbacks
+    std::string bench_add("function bench_add(a, b) return a + b end");
+    lua::run_string(env, bench_add);
+    lua::clear(env);
+    benchmark("call Lua function through lua::call", runs, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            lua::call(env["bench_add"], i, 2);
+        }
+    });
+
+    benchmark("call Lua function with a persistent error handler", runs, [&](const long runs) {
+        auto handler = lua::push_error_handler(env);
+        for (long i = 0; i < runs; ++i) {
+            lua::push(env, env["bench_add"]);
+            lua::push(env, i, 2);
+            lua::invoke(lua::index(env, handler.pos() + 1));
+            lua_settop(env, handler.pos());
+        }
+        lua::clear(env);
+    });
+
+    lua::function<int(long, int)> bench_add_function(env["bench_add"]);
+    benchmark("call Lua function through lua::function", runs, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            bench_add_function(i, 2);
+        }
+    });
+
+    std::vector<double> bench_records(1000, 1.5);
+    lua::run_string(env, "function bench_transform(x) return x + 2 end");
+    lua::clear(env);
+    benchmark("transform records with lua::call (per 1000 records)", runs / 1000, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            std::vector<double> results;
+            results.reserve(bench_records.size());
+            for (auto record : bench_records) {
+                results.push_back(lua::call<double>(env["bench_transform"], record));
+                lua::clear(env);
+            }
+        }
+    });
+
+    benchmark("transform records with lua::map (per 1000 records)", runs / 1000, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            auto results = lua::map<std::vector<double>>(env["bench_transform"], bench_records);
+        }
+    });
+
+    // Failing calls, whose errors are caught and discarded
+    std::string bench_fail(
+        "local function inner() error('Intentional') end\n"
+        "function bench_fail() inner() end\n"
+    );
+    lua::run_string(env, bench_fail);
+    lua::clear(env);
+    benchmark("catch a Lua error from lua::call", runs / 10, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            try {
+                lua::call(env["bench_fail"]);
+            } catch (lua::error& ex) {
+            }
+            lua::clear(env);
+        }
+    });
+
+    lua::capture_tracebacks(env, false);
+    benchmark("catch a Lua error from lua::call, without tracebacks", runs / 10, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            try {
+                lua::call(env["bench_fail"]);
+            } catch (lua::error& ex) {
+            }
+            lua::clear(env);
+        }
+    });
+    lua::capture_tracebacks(env, true);
+
+    // Short-lived states, either created each time or leased from a pool
+    std::string bench_script("local total = 0 for i = 1, 10 do total = total + i end scratch = total");
+    benchmark("create a state and run a short script", runs / 100, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            auto short_env = lua::create();
+            lua::run_string(short_env, bench_script);
+        }
+    });
+
+    lua::state_pool bench_pool(1);
+    benchmark("lease a pooled state and run a short script", runs / 100, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            auto lease = bench_pool.acquire();
+            lua::run_string(lease.env(), bench_script);
+        }
+    });
+
+    // A CPU-bound transform, run in one state, or across one state per core
+    std::string bench_heavy(
+        "function bench_heavy(x)\n"
+        "    local total = 0\n"
+        "    for i = 1, 200 do total = total + math.sqrt(x * i) end\n"
+        "    return total\n"
+        "end\n"
+    );
+    lua::run_string(env, bench_heavy);
+    lua::clear(env);
+    benchmark("heavy transform with lua::map (per 1000 records)", runs / 10000, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            auto results = lua::map<std::vector<double>>(env["bench_heavy"], bench_records);
+        }
+    });
+
+    lua::state_pool bench_workers(std::max(1u, std::thread::hardware_concurrency()), lua::chunk_initializer(bench_heavy));
+    benchmark("heavy transform with lua::parallel_map (per 1000 records)", runs / 10000, [&](const long runs) {
+        for (long i = 0; i < runs; ++i) {
+            auto results = lua::parallel_map<std::vector<double>>(bench_workers, "bench_heavy", bench_records);
+        }
+    });
+
+    return 0;
+}
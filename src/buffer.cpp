@@ -0,0 +1,365 @@
+#include "buffer.hpp"
+
+#include "convert/callable.hpp"
+#include "convert/vector.hpp"
+#include "thread.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <sstream>
+
+namespace {
+
+// Runs the body, raising any error it throws as a Lua error.
+template <class Body>
+int raise_errors(lua_State* const state, Body body)
+{
+    try {
+        return body();
+    } catch (lua::error& ex) {
+        lua::push(state, ex);
+    } catch (std::bad_alloc&) {
+        lua_pushstring(state, "lua::buffer: Not enough memory for the buffer");
+    }
+    return lua_error(state);
+}
+
+// Returns the buffer at the given position. A buffer of any other element
+// type, or any other value, is refused rather than read as a buffer of T.
+template <class T>
+lua::buffer<T>& buffer_argument(lua_State* const state, const int pos, const char* const operation)
+{
+    if (!lua::is_type<lua::buffer<T>>(state, pos)) {
+        auto name = lua::class_name(state, pos);
+        std::stringstream str;
+        str << "lua::buffer::" << operation << ": Argument " << pos << " must be a "
+            << lua::buffer_type<T>::metatable_name << ", but a "
+            << (name.empty() ? lua_typename(state, lua_type(state, pos)) : name)
+            << " was given";
+        throw lua::error(str.str());
+    }
+    return *lua::get<lua::buffer<T>*>(state, pos);
+}
+
+template <class T>
+T number_argument(lua_State* const state, const int pos, const char* const operation)
+{
+    if (lua_type(state, pos) != LUA_TNUMBER) {
+        std::stringstream str;
+        str << "lua::buffer::" << operation << ": Argument " << pos << " must be a number, but a "
+            << lua_typename(state, lua_type(state, pos)) << " was given";
+        throw lua::error(str.str());
+    }
+    T value = T();
+    lua::SequenceElement<T>::store(value, state, pos);
+    return value;
+}
+
+template <class T>
+int buffer_index(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        auto& buf = buffer_argument<T>(state, 1, "__index");
+
+        if (lua_type(state, 2) == LUA_TNUMBER) {
+            auto index = lua_tointeger(state, 2);
+            if (index < 1 || static_cast<size_t>(index) > buf.size()) {
+                lua_pushnil(state);
+                return 1;
+            }
+            lua::SequenceElement<T>::push(state, buf[index - 1]);
+            return 1;
+        }
+
+        // Not an element, so look for a method
+        lua_getmetatable(state, 1);
+        lua_pushvalue(state, 2);
+        lua_rawget(state, -2);
+        return 1;
+    });
+}
+
+template <class T>
+int buffer_newindex(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        auto& buf = buffer_argument<T>(state, 1, "__newindex");
+
+        // Only elements can be set, so names aren't converted to numbers
+        if (lua_type(state, 2) != LUA_TNUMBER) {
+            std::stringstream str;
+            str << "lua::buffer: Only numeric indices can be set, but a "
+                << lua_typename(state, lua_type(state, 2)) << " was given";
+            throw lua::error(str.str());
+        }
+        auto number = lua_tonumber(state, 2);
+        auto index = lua_tointeger(state, 2);
+        if (static_cast<lua_Number>(index) != number || index < 1 || static_cast<size_t>(index) > buf.size()) {
+            std::stringstream str;
+            str << "lua::buffer: Index " << number << " is out of range for a buffer of size " << buf.size();
+            throw lua::error(str.str());
+        }
+        buf[index - 1] = number_argument<T>(state, 3, "__newindex");
+        return 0;
+    });
+}
+
+template <class T>
+int buffer_len(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        lua::push(state, buffer_argument<T>(state, 1, "__len").size());
+        return 1;
+    });
+}
+
+template <class T>
+int buffer_size(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        lua::push(state, buffer_argument<T>(state, 1, "size").size());
+        return 1;
+    });
+}
+
+template <class T>
+int buffer_fill(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        buffer_argument<T>(state, 1, "fill").fill(number_argument<T>(state, 2, "fill"));
+        return 0;
+    });
+}
+
+template <class T>
+int buffer_scale(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        buffer_argument<T>(state, 1, "scale").scale(number_argument<T>(state, 2, "scale"));
+        return 0;
+    });
+}
+
+template <class T>
+int buffer_add(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        auto& buf = buffer_argument<T>(state, 1, "add");
+        if (lua_type(state, 2) == LUA_TNUMBER) {
+            buf.add(number_argument<T>(state, 2, "add"));
+        } else {
+            buf.add(buffer_argument<T>(state, 2, "add"));
+        }
+        return 0;
+    });
+}
+
+template <class T>
+int buffer_multiply_add(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        buffer_argument<T>(state, 1, "multiply_add").multiply_add(
+            buffer_argument<T>(state, 2, "multiply_add"),
+            number_argument<T>(state, 3, "multiply_add")
+        );
+        return 0;
+    });
+}
+
+template <class T>
+int buffer_clamp(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        buffer_argument<T>(state, 1, "clamp").clamp(
+            number_argument<T>(state, 2, "clamp"),
+            number_argument<T>(state, 3, "clamp")
+        );
+        return 0;
+    });
+}
+
+template <class T>
+int buffer_dot(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        auto& buf = buffer_argument<T>(state, 1, "dot");
+        lua::push(state, buf.dot(buffer_argument<T>(state, 2, "dot")));
+        return 1;
+    });
+}
+
+template <class T>
+int buffer_sum(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        lua::push(state, buffer_argument<T>(state, 1, "sum").sum());
+        return 1;
+    });
+}
+
+template <class T>
+int buffer_min(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        lua::SequenceElement<T>::push(state, buffer_argument<T>(state, 1, "min").min());
+        return 1;
+    });
+}
+
+template <class T>
+int buffer_max(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        lua::SequenceElement<T>::push(state, buffer_argument<T>(state, 1, "max").max());
+        return 1;
+    });
+}
+
+template <class T>
+int buffer_table(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        auto& buf = buffer_argument<T>(state, 1, "table");
+        lua::push_sequence(state, buf.begin(), buf.end(), buf.size());
+        return 1;
+    });
+}
+
+template <class T>
+int buffer_tostring(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        // Print something like buffer.float(1024)
+        auto& buf = buffer_argument<T>(state, 1, "__tostring");
+        std::stringstream str;
+        str << "buffer." << lua::buffer_type<T>::name << "(" << buf.size() << ")";
+        lua::push(state, str.str());
+        return 1;
+    });
+}
+
+// Pushes the source converted to U, if U is the named type.
+template <class T, class U>
+bool convert_to(lua_State* const state, const lua::buffer<T>& source, const char* const name)
+{
+    if (std::strcmp(name, lua::buffer_type<U>::name) != 0) {
+        return false;
+    }
+    lua::make<lua::buffer<U>>(state, source.template convert<U>(state));
+    return true;
+}
+
+template <class T>
+int buffer_convert(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        auto& buf = buffer_argument<T>(state, 1, "convert");
+        auto name = lua_tostring(state, 2);
+        if (!name) {
+            throw lua::error("lua::buffer::convert: A buffer type name must be given");
+        }
+        if (
+            convert_to<T, float>(state, buf, name) ||
+            convert_to<T, double>(state, buf, name) ||
+            convert_to<T, int8_t>(state, buf, name) ||
+            convert_to<T, int16_t>(state, buf, name) ||
+            convert_to<T, int32_t>(state, buf, name) ||
+            convert_to<T, int64_t>(state, buf, name) ||
+            convert_to<T, uint8_t>(state, buf, name) ||
+            convert_to<T, uint16_t>(state, buf, name) ||
+            convert_to<T, uint32_t>(state, buf, name) ||
+            convert_to<T, uint64_t>(state, buf, name)
+        ) {
+            return 1;
+        }
+        throw lua::error(std::string("lua::buffer::convert: Unknown buffer type: ") + name);
+    });
+}
+
+// Creates a buffer from a size, or from a table of values.
+template <class T>
+int buffer_new(lua_State* const state)
+{
+    return raise_errors(state, [state]() {
+        if (lua_type(state, 1) == LUA_TTABLE) {
+            auto source = lua::index(state, 1);
+            auto size = lua::sequence_length(source, lua::buffer_type<T>::metatable_name);
+            auto buf = lua::make<lua::buffer<T>>(state, state, size);
+            lua::store_sequence(buf->begin(), source, size);
+            return 1;
+        }
+
+        if (lua_type(state, 1) != LUA_TNUMBER) {
+            throw lua::error("lua::buffer: A buffer must be created from a size or a table of values");
+        }
+
+        // Refuse negative, fractional, NaN, and impossibly large sizes
+        auto size = lua_tonumber(state, 1);
+        auto max_size = std::numeric_limits<size_t>::max() / sizeof(T) / 2;
+        if (!(size >= 0) || size != std::floor(size) || size > static_cast<lua_Number>(max_size)) {
+            std::stringstream str;
+            str << "lua::buffer: " << size << " is not a valid buffer size";
+            throw lua::error(str.str());
+        }
+        lua::make<lua::buffer<T>>(state, state, static_cast<size_t>(size));
+        return 1;
+    });
+}
+
+} // namespace anonymous
+
+template <class T>
+void lua::buffer_metatable(const lua::index& mt)
+{
+    mt["__index"] = buffer_index<T>;
+    mt["__newindex"] = buffer_newindex<T>;
+    mt["__len"] = buffer_len<T>;
+    mt["__tostring"] = buffer_tostring<T>;
+
+    mt["size"] = buffer_size<T>;
+    mt["fill"] = buffer_fill<T>;
+    mt["scale"] = buffer_scale<T>;
+    mt["add"] = buffer_add<T>;
+    mt["multiply_add"] = buffer_multiply_add<T>;
+    mt["clamp"] = buffer_clamp<T>;
+    mt["dot"] = buffer_dot<T>;
+    mt["sum"] = buffer_sum<T>;
+    mt["min"] = buffer_min<T>;
+    mt["max"] = buffer_max<T>;
+    mt["convert"] = buffer_convert<T>;
+    mt["table"] = buffer_table<T>;
+}
+
+template void lua::buffer_metatable<float>(const lua::index&);
+template void lua::buffer_metatable<double>(const lua::index&);
+template void lua::buffer_metatable<int8_t>(const lua::index&);
+template void lua::buffer_metatable<int16_t>(const lua::index&);
+template void lua::buffer_metatable<int32_t>(const lua::index&);
+template void lua::buffer_metatable<int64_t>(const lua::index&);
+template void lua::buffer_metatable<uint8_t>(const lua::index&);
+template void lua::buffer_metatable<uint16_t>(const lua::index&);
+template void lua::buffer_metatable<uint32_t>(const lua::index&);
+template void lua::buffer_metatable<uint64_t>(const lua::index&);
+
+int luaopen_luacxx_buffer(lua_State* const state)
+{
+    lua::thread env(state);
+
+    env["buffer"] = lua::value::table;
+    lua::pinned t(env["buffer"]);
+
+    t[lua::buffer_type<float>::name] = buffer_new<float>;
+    t[lua::buffer_type<double>::name] = buffer_new<double>;
+    t[lua::buffer_type<int8_t>::name] = buffer_new<int8_t>;
+    t[lua::buffer_type<int16_t>::name] = buffer_new<int16_t>;
+    t[lua::buffer_type<int32_t>::name] = buffer_new<int32_t>;
+    t[lua::buffer_type<int64_t>::name] = buffer_new<int64_t>;
+    t[lua::buffer_type<uint8_t>::name] = buffer_new<uint8_t>;
+    t[lua::buffer_type<uint16_t>::name] = buffer_new<uint16_t>;
+    t[lua::buffer_type<uint32_t>::name] = buffer_new<uint32_t>;
+    t[lua::buffer_type<uint64_t>::name] = buffer_new<uint64_t>;
+
+    return 0;
+}
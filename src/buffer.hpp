@@ -0,0 +1,535 @@
+#ifndef LUACXX_BUFFER_INCLUDED
+#define LUACXX_BUFFER_INCLUDED
+
+#include "stack.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+
+/*
+
+=head1 NAME
+
+lua::buffer - a typed array of numbers, shared between C++ and Lua
+
+=head1 SYNOPSIS
+
+    #include <luacxx/buffer.hpp>
+
+    // From C++
+    lua::buffer<float> samples(1024);
+    samples.fill(1);
+    samples.scale(.5);
+    env["samples"] = std::move(samples);
+
+    -- From Lua
+    require "luacxx.buffer";
+
+    local samples = buffer.float(1024);
+    samples:fill(1);
+    samples[1] = 42;
+    print(#samples, samples:sum(), samples:max());
+
+    -- Bindings receive the same memory, without copying
+    process_samples(samples);
+
+    void process_samples(const lua::buffer<float>& samples)
+    {
+        compute(samples.data(), samples.size());
+    }
+
+=head1 DESCRIPTION
+
+Numeric work from Lua usually means tables of numbers, or many small calls into
+bindings. A lua::buffer is instead a contiguous, aligned C++ array of a single
+numeric type, stored in a userdata, with bulk operations that run entirely in
+C++. Its elements can also be read and written from Lua one at a time, using
+the usual indexing syntax and 1-based indices.
+
+Buffers can hold float, double, and the signed and unsigned 8, 16, 32, and
+64-bit integers. Their memory is aligned to lua::buffer<T>::alignment bytes,
+and the bulk operations are simple loops over that memory, written so the
+compiler can vectorize them.
+
+Bindings accept buffers by reference or by pointer, like any other userdata,
+and use data() and size() to reach the array directly.
+
+=head4 lua::buffer<T>(size), lua::buffer<T>(data, size), lua::buffer<T>(state, size)
+
+Creates a buffer of the given size, either filled with zeroes or copied from
+the given data. Given a state, the elements are allocated by that state's
+allocator, so they count towards the limit of a lua::accounting_allocator,
+and the buffer must not outlive the state. Copies of a buffer are always
+allocated separately from any state.
+
+=head4 buffer.float(size), buffer.float(table), ...
+
+From Lua, a new buffer is created from its size or a table of its values. There
+is one constructor per type: float, double, int8, int16, int32, int64, uint8,
+uint16, uint32, and uint64. Buffers created from Lua use the state's
+allocator. A size must be a whole number that fits in memory.
+
+=head4 fill(value), scale(factor), add(value), clamp(low, high)
+
+Sets each element to the value, multiplies each by factor, adds value to each,
+or limits each to the given range. add() also accepts another buffer of the
+same size, which is added element-wise.
+
+=head4 multiply_add(other, factor)
+
+Adds other multiplied by factor to each element, so the buffer holds
+buffer + other * factor.
+
+=head4 dot(other), sum(), min(), max()
+
+Returns the dot product with the other buffer, or the sum, minimum, or maximum
+of the elements. Sums are accumulated as lua_Number. min() and max() throw for
+an empty buffer.
+
+From Lua, every buffer given to a method, including the buffer itself, must
+have the method's element type; add(), multiply_add() and dot() don't convert
+between buffer types.
+
+=head4 convert<U>(), convert<U>(state), convert(type_name)
+
+Returns a new buffer with each element converted to the given type, allocated
+by the given state, if any. Floating-point values that the new type can't hold
+are clamped to its range, and NaN becomes zero.
+
+=head4 table()
+
+From Lua, returns a new table containing the buffer's elements.
+
+*/
+
+namespace lua {
+
+template <class T>
+struct buffer_type;
+
+template <>
+struct buffer_type<float>
+{
+    static constexpr const char* name = "float";
+    static constexpr const char* metatable_name = "lua::buffer<float>";
+};
+
+template <>
+struct buffer_type<double>
+{
+    static constexpr const char* name = "double";
+    static constexpr const char* metatable_name = "lua::buffer<double>";
+};
+
+template <>
+struct buffer_type<int8_t>
+{
+    static constexpr const char* name = "int8";
+    static constexpr const char* metatable_name = "lua::buffer<int8_t>";
+};
+
+template <>
+struct buffer_type<int16_t>
+{
+    static constexpr const char* name = "int16";
+    static constexpr const char* metatable_name = "lua::buffer<int16_t>";
+};
+
+template <>
+struct buffer_type<int32_t>
+{
+    static constexpr const char* name = "int32";
+    static constexpr const char* metatable_name = "lua::buffer<int32_t>";
+};
+
+template <>
+struct buffer_type<int64_t>
+{
+    static constexpr const char* name = "int64";
+    static constexpr const char* metatable_name = "lua::buffer<int64_t>";
+};
+
+template <>
+struct buffer_type<uint8_t>
+{
+    static constexpr const char* name = "uint8";
+    static constexpr const char* metatable_name = "lua::buffer<uint8_t>";
+};
+
+template <>
+struct buffer_type<uint16_t>
+{
+    static constexpr const char* name = "uint16";
+    static constexpr const char* metatable_name = "lua::buffer<uint16_t>";
+};
+
+template <>
+struct buffer_type<uint32_t>
+{
+    static constexpr const char* name = "uint32";
+    static constexpr const char* metatable_name = "lua::buffer<uint32_t>";
+};
+
+template <>
+struct buffer_type<uint64_t>
+{
+    static constexpr const char* name = "uint64";
+    static constexpr const char* metatable_name = "lua::buffer<uint64_t>";
+};
+
+template <class T>
+class buffer
+{
+    static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value,
+        "lua::buffer only holds numbers");
+
+    T* _data;
+    size_t _size;
+
+    // The state allocator that owns the elements, or nullptr if they came
+    // from posix_memalign.
+    lua_Alloc _alloc;
+    void* _alloc_data;
+
+    // The block given by _alloc, which is larger than the elements so they
+    // can be aligned within it.
+    void* _block;
+
+    // Returns the bytes used by size elements, or throws if it's too many.
+    static size_t byte_size(const size_t size)
+    {
+        if (size > (std::numeric_limits<size_t>::max() - alignment) / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return size * sizeof(T);
+    }
+
+    void allocate(const size_t size)
+    {
+        if (size == 0) {
+            return;
+        }
+        auto bytes = byte_size(size);
+        if (_alloc) {
+            _block = _alloc(_alloc_data, nullptr, 0, bytes + alignment);
+            if (!_block) {
+                throw std::bad_alloc();
+            }
+            auto address = reinterpret_cast<std::uintptr_t>(_block);
+            _data = reinterpret_cast<T*>((address + alignment - 1) / alignment * alignment);
+        } else {
+            void* memory = nullptr;
+            if (posix_memalign(&memory, alignment, bytes) != 0) {
+                throw std::bad_alloc();
+            }
+            _data = static_cast<T*>(memory);
+        }
+        _size = size;
+    }
+
+    void release()
+    {
+        if (_alloc) {
+            if (_block) {
+                _alloc(_alloc_data, _block, byte_size(_size) + alignment, 0);
+            }
+        } else {
+            std::free(_data);
+        }
+        _data = nullptr;
+        _block = nullptr;
+        _size = 0;
+    }
+
+    void check_size(const lua::buffer<T>& other, const char* const operation) const
+    {
+        if (other.size() != size()) {
+            std::stringstream str;
+            str << "lua::buffer::" << operation << ": Buffers must have the same size, but "
+                << size() << " and " << other.size() << " were given";
+            throw lua::error(str.str());
+        }
+    }
+
+    void check_not_empty(const char* const operation) const
+    {
+        if (empty()) {
+            std::stringstream str;
+            str << "lua::buffer::" << operation << ": Buffer must not be empty";
+            throw lua::error(str.str());
+        }
+    }
+
+public:
+    typedef T value_type;
+
+    // The alignment of the buffer's elements, in bytes.
+    static const size_t alignment = 64;
+
+    explicit buffer(const size_t size = 0) :
+        buffer(static_cast<lua_State*>(nullptr), size)
+    {
+    }
+
+    buffer(lua_State* const state, const size_t size) :
+        _data(nullptr),
+        _size(0),
+        _alloc(nullptr),
+        _alloc_data(nullptr),
+        _block(nullptr)
+    {
+        if (state) {
+            _alloc = lua_getallocf(state, &_alloc_data);
+        }
+        allocate(size);
+        std::fill(begin(), end(), T());
+    }
+
+    buffer(const T* const data, const size_t size) :
+        _data(nullptr),
+        _size(0),
+        _alloc(nullptr),
+        _alloc_data(nullptr),
+        _block(nullptr)
+    {
+        allocate(size);
+        std::copy(data, data + size, begin());
+    }
+
+    buffer(const lua::buffer<T>& other) :
+        buffer(other.data(), other.size())
+    {
+    }
+
+    buffer(lua::buffer<T>&& other) :
+        _data(other._data),
+        _size(other._size),
+        _alloc(other._alloc),
+        _alloc_data(other._alloc_data),
+        _block(other._block)
+    {
+        other._data = nullptr;
+        other._size = 0;
+        other._block = nullptr;
+    }
+
+    lua::buffer<T>& operator=(lua::buffer<T> other)
+    {
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+        std::swap(_alloc, other._alloc);
+        std::swap(_alloc_data, other._alloc_data);
+        std::swap(_block, other._block);
+        return *this;
+    }
+
+    ~buffer()
+    {
+        release();
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    T* data()
+    {
+        return _data;
+    }
+
+    const T* data() const
+    {
+        return _data;
+    }
+
+    T* begin()
+    {
+        return _data;
+    }
+
+    T* end()
+    {
+        return _data + _size;
+    }
+
+    const T* begin() const
+    {
+        return _data;
+    }
+
+    const T* end() const
+    {
+        return _data + _size;
+    }
+
+    T& operator[](const size_t index)
+    {
+        return _data[index];
+    }
+
+    const T& operator[](const size_t index) const
+    {
+        return _data[index];
+    }
+
+    void fill(const T value)
+    {
+        T* const data = _data;
+        for (size_t i = 0; i < _size; ++i) {
+            data[i] = value;
+        }
+    }
+
+    void scale(const T factor)
+    {
+        T* const data = _data;
+        for (size_t i = 0; i < _size; ++i) {
+            data[i] *= factor;
+        }
+    }
+
+    void add(const T value)
+    {
+        T* const data = _data;
+        for (size_t i = 0; i < _size; ++i) {
+            data[i] += value;
+        }
+    }
+
+    void add(const lua::buffer<T>& other)
+    {
+        check_size(other, "add");
+        T* const data = _data;
+        const T* const other_data = other._data;
+        for (size_t i = 0; i < _size; ++i) {
+            data[i] += other_data[i];
+        }
+    }
+
+    void multiply_add(const lua::buffer<T>& other, const T factor)
+    {
+        check_size(other, "multiply_add");
+        T* const data = _data;
+        const T* const other_data = other._data;
+        for (size_t i = 0; i < _size; ++i) {
+            data[i] += other_data[i] * factor;
+        }
+    }
+
+    void clamp(const T low, const T high)
+    {
+        T* const data = _data;
+        for (size_t i = 0; i < _size; ++i) {
+            data[i] = data[i] < low ? low : (high < data[i] ? high : data[i]);
+        }
+    }
+
+    lua_Number dot(const lua::buffer<T>& other) const
+    {
+        check_size(other, "dot");
+
+        // Several partial sums, so each addition needn't wait for the last
+        const T* const data = _data;
+        const T* const other_data = other._data;
+        lua_Number partial[4] = {0, 0, 0, 0};
+        size_t i = 0;
+        for (; i + 4 <= _size; i += 4) {
+            partial[0] += static_cast<lua_Number>(data[i]) * other_data[i];
+            partial[1] += static_cast<lua_Number>(data[i + 1]) * other_data[i + 1];
+            partial[2] += static_cast<lua_Number>(data[i + 2]) * other_data[i + 2];
+            partial[3] += static_cast<lua_Number>(data[i + 3]) * other_data[i + 3];
+        }
+        for (; i < _size; ++i) {
+            partial[0] += static_cast<lua_Number>(data[i]) * other_data[i];
+        }
+        return (partial[0] + partial[1]) + (partial[2] + partial[3]);
+    }
+
+    lua_Number sum() const
+    {
+        const T* const data = _data;
+        lua_Number partial[4] = {0, 0, 0, 0};
+        size_t i = 0;
+        for (; i + 4 <= _size; i += 4) {
+            partial[0] += data[i];
+            partial[1] += data[i + 1];
+            partial[2] += data[i + 2];
+            partial[3] += data[i + 3];
+        }
+        for (; i < _size; ++i) {
+            partial[0] += data[i];
+        }
+        return (partial[0] + partial[1]) + (partial[2] + partial[3]);
+    }
+
+    T min() const
+    {
+        check_not_empty("min");
+        const T* const data = _data;
+        T rv = data[0];
+        for (size_t i = 1; i < _size; ++i) {
+            rv = data[i] < rv ? data[i] : rv;
+        }
+        return rv;
+    }
+
+    T max() const
+    {
+        check_not_empty("max");
+        const T* const data = _data;
+        T rv = data[0];
+        for (size_t i = 1; i < _size; ++i) {
+            rv = rv < data[i] ? data[i] : rv;
+        }
+        return rv;
+    }
+
+    template <class U>
+    lua::buffer<U> convert(lua_State* const state = nullptr) const
+    {
+        lua::buffer<U> rv(state, _size);
+        const T* const data = _data;
+        U* const rv_data = rv.data();
+        for (size_t i = 0; i < _size; ++i) {
+            rv_data[i] = lua::clamp_number<U>(data[i]);
+        }
+        return rv;
+    }
+};
+
+template <class T>
+const size_t buffer<T>::alignment;
+
+// Sets up the Lua methods of a buffer; defined for each buffer_type.
+template <class T>
+void buffer_metatable(const lua::index& mt);
+
+template <class T>
+struct Metatable<lua::buffer<T>>
+{
+    static constexpr const char* name = lua::buffer_type<T>::metatable_name;
+
+    static bool metatable(const lua::index& mt, lua::buffer<T>* const)
+    {
+        lua::buffer_metatable<T>(mt);
+        return true;
+    }
+};
+
+} // namespace lua
+
+extern "C" int luaopen_luacxx_buffer(lua_State* const);
+
+#endif // LUACXX_BUFFER_INCLUDED
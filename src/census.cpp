@@ -0,0 +1,100 @@
+#include "census.hpp"
+
+#include "convert/callable.hpp"
+#include "convert/numeric.hpp"
+#include "convert/string.hpp"
+#include "table_builder.hpp"
+#include "thread.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+
+namespace {
+
+// Types are added at the front, and never removed, so the list can be read
+// without locking.
+std::atomic<const lua::userdata_type*> census_head(nullptr);
+std::mutex census_mutex;
+
+int census_counts(lua_State* const state)
+{
+    lua::table_builder counts(state);
+    for (auto& entry : lua::census()) {
+        lua_getfield(state, counts.table().pos(), entry.name);
+        if (lua_istable(state, -1)) {
+            // Another type has the same name
+            lua::table_builder existing(lua::index(state, -1));
+            lua_getfield(state, -1, "live");
+            auto live = lua_tonumber(state, -1);
+            lua_getfield(state, -2, "bytes");
+            auto bytes = lua_tonumber(state, -1);
+            lua_pop(state, 2);
+            existing.set("live", live + entry.live);
+            existing.set("bytes", bytes + entry.bytes);
+            lua_pop(state, 1);
+            continue;
+        }
+        lua_pop(state, 1);
+
+        lua::table_builder(state, 0, 2)
+            .set("live", entry.live)
+            .set("bytes", entry.bytes);
+        lua_setfield(state, counts.table().pos(), entry.name);
+    }
+    return 1;
+}
+
+} // namespace anonymous
+
+void lua::userdata_type::add_to_census() const
+{
+    std::lock_guard<std::mutex> lock(census_mutex);
+    if (listed.load(std::memory_order_relaxed)) {
+        return;
+    }
+    next = census_head.load(std::memory_order_relaxed);
+    census_head.store(this, std::memory_order_release);
+    listed.store(true, std::memory_order_release);
+}
+
+std::vector<lua::census_entry> lua::census()
+{
+    std::vector<lua::census_entry> rv;
+    for (auto type = census_head.load(std::memory_order_acquire); type; type = type->next) {
+        rv.push_back(lua::census_entry {
+            type->name ? type->name : "",
+            type->live.load(std::memory_order_relaxed),
+            type->bytes.load(std::memory_order_relaxed)
+        });
+    }
+    std::stable_sort(rv.begin(), rv.end(), [](const lua::census_entry& a, const lua::census_entry& b) {
+        return a.bytes > b.bytes;
+    });
+    return rv;
+}
+
+std::string lua::dump_census()
+{
+    std::stringstream str;
+    for (auto& entry : lua::census()) {
+        if (entry.live == 0) {
+            continue;
+        }
+        str << entry.name << ": " << entry.live << " live, " << entry.bytes << " bytes\n";
+    }
+    return str.str();
+}
+
+int luaopen_luacxx_census(lua_State* const state)
+{
+    lua::thread env(state);
+
+    env["census"] = lua::value::table;
+    lua::pinned t(env["census"]);
+
+    t["counts"] = census_counts;
+    t["dump"] = lua::dump_census;
+
+    return 0;
+}
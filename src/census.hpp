@@ -0,0 +1,80 @@
+#ifndef LUACXX_CENSUS_INCLUDED
+#define LUACXX_CENSUS_INCLUDED
+
+#include "stack.hpp"
+
+#include <string>
+#include <vector>
+
+/*
+
+=head1 NAME
+
+lua::census - count the live userdata of each class
+
+=head1 SYNOPSIS
+
+    #include <luacxx/census.hpp>
+
+    std::cerr << lua::dump_census() << std::endl;
+
+    for (auto& entry : lua::census()) {
+        if (entry.live > 1000000) {
+            std::cerr << "Too many " << entry.name << " userdata" << std::endl;
+        }
+    }
+
+    -- From Lua, after luaopen_luacxx_census
+    print(census.dump())
+    print(census.counts().QPointF.live)
+
+=head1 DESCRIPTION
+
+Every userdata created by lua::push or lua::make is counted by its C++ type,
+along with its size in bytes, and uncounted when it's collected. The counters
+are atomic and shared by every state in the process, so the census is always
+available, and costs little more than an increment. Types only appear in the
+census once their first userdata has been created.
+
+Sizes are those of the userdata, including its userdata_block. Userdata that
+hold pointers are counted as the size of the pointer, since Lua doesn't own the
+value.
+
+=head4 std::vector<lua::census_entry> lua::census()
+
+Returns the counters of every type, sorted by bytes, largest first. Each
+census_entry has the type's name, and its live and bytes counters.
+
+=head4 std::string lua::dump_census()
+
+Returns a line for each type with live userdata, sorted like lua::census():
+
+    QPointF: 2000000 live, 64000000 bytes
+
+=head4 luaopen_luacxx_census(state)
+
+Adds a census table to Lua's globals. census.counts() returns a table of
+{ live = n, bytes = n } tables, keyed by class name, and census.dump() returns
+the same string as lua::dump_census(). Different C++ types with the same name,
+such as the QLists of each element type, are added together.
+
+*/
+
+namespace lua {
+
+struct census_entry
+{
+    const char* name;
+    size_t live;
+    size_t bytes;
+};
+
+std::vector<lua::census_entry> census();
+
+std::string dump_census();
+
+} // namespace lua
+
+extern "C" int luaopen_luacxx_census(lua_State* const);
+
+#endif // LUACXX_CENSUS_INCLUDED
@@ -0,0 +1,61 @@
+#ifndef LUACXX_CONVERT_ARRAY_INCLUDED
+#define LUACXX_CONVERT_ARRAY_INCLUDED
+
+#include "vector.hpp"
+
+#include <array>
+
+/*
+
+=head1 NAME
+
+convert/array.hpp - support for std::array as a Lua array
+
+=head1 SYNOPSIS
+
+    #include <luacxx/convert/array.hpp>
+
+    std::array<float, 3> position {{ 1, 2, 3 }};
+    env["position"] = position;
+
+=head1 DESCRIPTION
+
+Arrays are pushed as new tables, using the same conversions as std::vector.
+
+A table stored into a std::array fills it from the start. The table must not
+have more elements than the array; any elements after the table's are left
+unchanged.
+
+*/
+
+namespace lua {
+
+template <class T, size_t N>
+struct Push<std::array<T, N>>
+{
+    static void push(lua_State* const state, const std::array<T, N>& source)
+    {
+        lua::push_sequence(state, source.begin(), source.end(), N);
+    }
+};
+
+template <class T, size_t N>
+struct Store<std::array<T, N>>
+{
+    static void store(std::array<T, N>& destination, const lua::index& source)
+    {
+        auto num_elements = lua::sequence_length(source, "std::array<T, N>");
+        if (num_elements > N) {
+            std::stringstream str;
+            str << "Lua table at position " << source.pos() << " has " << num_elements
+                << " elements, but the std::array can only hold " << N;
+            throw lua::error(str.str());
+        }
+
+        lua::store_sequence(destination.begin(), source, num_elements);
+    }
+};
+
+} // namespace lua
+
+#endif // LUACXX_CONVERT_ARRAY_INCLUDED
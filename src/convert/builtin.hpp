@@ -141,7 +141,7 @@ struct Store<const lua::index>
 template <class Source, class Name>
 struct Push<lua::link<Source, Name>>
 {
-    static void push(lua_State* const state, lua::link<Source, Name>& source)
+    static void push(lua_State* const state, const lua::link<Source, Name>& source)
     {
         lua::push(state, source.source());
         lua::push(state, source.name());
@@ -179,15 +179,7 @@ struct Store<lua::userdata_block*>
 {
     static void store(lua::userdata_block*& destination, const lua::index& source)
     {
-        char* block = static_cast<char*>(lua_touserdata(source.state(), source.pos()));
-        if (!block) {
-            destination = nullptr;
-            return;
-        }
-
-        destination = reinterpret_cast<lua::userdata_block*>(
-            block + lua_rawlen(source.state(), source.pos()) - sizeof(lua::userdata_block)
-        );
+        destination = lua::find_userdata_block(source.state(), source.pos());
     }
 };
 
@@ -3,6 +3,9 @@
 
 #include <functional>
 #include <sstream>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include "../algorithm.hpp"
 #include "../stack.hpp"
@@ -174,9 +177,10 @@ static int invoke_callable(lua_State* const state)
 template <>
 struct Push<lua::callable>
 {
-    static void push(lua_State* const state, const lua::callable& callable)
+    template <class Callable>
+    static void push(lua_State* const state, Callable&& callable)
     {
-        Construct<lua::callable>::construct(state, callable);
+        Construct<lua::callable>::construct(state, std::forward<Callable>(callable));
         lua_pushcclosure(state, invoke_callable, 1);
     }
 };
@@ -203,12 +207,102 @@ struct Metatable<lua::callable>
 
     static bool metatable(const lua::index& table, void* const value)
     {
-        return false;
+        return true;
     }
 };
 
 } // namespace lua
 
+/*
+
+=head4 struct lua::Returns<RV>
+
+Pushes the value returned by a bound function as its Lua results, and returns
+how many there are. Most values are a single result, but std::tuple and
+std::pair are pushed as one result per element, so a function can return
+several values without a table:
+
+    std::tuple<bool, int, int> get_repeat(Device* const device)
+    {
+        int delay, period;
+        bool ok = device->get_repeat(&delay, &period);
+        return std::make_tuple(ok, delay, period);
+    }
+
+    env["get_repeat"] = get_repeat;
+
+    -- And within Lua
+    local ok, delay, period = get_repeat(device);
+
+This is the way to bind C functions that use out-parameters: wrap them in a
+function that returns the out-parameters in a tuple.
+
+*/
+
+namespace lua {
+
+template <class T>
+struct Returns
+{
+    template <class Value>
+    static int push(lua_State* const state, Value&& value)
+    {
+        lua::push(state, std::forward<Value>(value));
+        return 1;
+    }
+};
+
+template <size_t I, size_t N>
+struct TupleReturns
+{
+    template <class Tuple>
+    static void push(lua_State* const state, Tuple&& value)
+    {
+        lua::push(state, std::get<I>(std::forward<Tuple>(value)));
+        TupleReturns<I + 1, N>::push(state, std::forward<Tuple>(value));
+    }
+};
+
+template <size_t N>
+struct TupleReturns<N, N>
+{
+    template <class Tuple>
+    static void push(lua_State* const state, Tuple&& value)
+    {
+    }
+};
+
+template <class... T>
+struct Returns<std::tuple<T...>>
+{
+    template <class Value>
+    static int push(lua_State* const state, Value&& value)
+    {
+        TupleReturns<0, sizeof...(T)>::push(state, std::forward<Value>(value));
+        return sizeof...(T);
+    }
+};
+
+template <class First, class Second>
+struct Returns<std::pair<First, Second>>
+{
+    template <class Value>
+    static int push(lua_State* const state, Value&& value)
+    {
+        TupleReturns<0, 2>::push(state, std::forward<Value>(value));
+        return 2;
+    }
+};
+
+// Pushes the given return value as Lua results, and returns their count.
+template <class Value>
+int push_returns(lua_State* const state, Value&& value)
+{
+    return lua::Returns<typename std::decay<Value>::type>::push(state, std::forward<Value>(value));
+}
+
+} // namespace lua
+
 namespace {
 
 struct ArgStop {};
@@ -217,10 +311,12 @@ template <typename Callee, typename RV, typename Arg, typename... Parameters>
 struct Invoke
 {
     template <typename... Arguments>
-    static int invoke(const Callee& func, lua::index& index, Arguments... arguments)
+    static int invoke(const Callee& func, lua::index& index, Arguments&&... arguments)
     {
+        // Arguments are forwarded through each step, so values retrieved from
+        // Lua are only moved, never copied, on their way to the callee.
         return Invoke<Callee, RV, Parameters...>::template invoke<Arguments..., Arg>(
-            func, index, arguments..., lua::get<Arg>(index++)
+            func, index, std::forward<Arguments>(arguments)..., lua::get<Arg>(index++)
         );
     }
 };
@@ -229,10 +325,9 @@ template <typename Callee, typename RV>
 struct Invoke<Callee, RV, ArgStop>
 {
     template <typename... Arguments>
-    static int invoke(const Callee& func, lua::index& index, Arguments... arguments)
+    static int invoke(const Callee& func, lua::index& index, Arguments&&... arguments)
     {
-        lua::push(index.state(), func(arguments...));
-        return 1;
+        return lua::push_returns(index.state(), func(std::forward<Arguments>(arguments)...));
     }
 };
 
@@ -240,9 +335,9 @@ template <typename Callee>
 struct Invoke<Callee, void, ArgStop>
 {
     template <typename... Arguments>
-    static int invoke(const Callee& func, lua::index& index, Arguments... arguments)
+    static int invoke(const Callee& func, lua::index& index, Arguments&&... arguments)
     {
-        func(arguments...);
+        func(std::forward<Arguments>(arguments)...);
         return 0;
     }
 };
@@ -272,6 +367,9 @@ This also supports C++ method pointers:
     // Equivalent to void get(Foo*, int, int);
     lua::push(state, &Foo::get);
 
+Function and method pointers are saved directly within the pushed closure, so
+calling them from Lua neither copies nor allocates anything.
+
 =head4 struct lua::Push<std::function<RV(Args...)>>
 
 This allows std::functions to be pushed directly onto the stack. This follows
@@ -289,30 +387,74 @@ signature, so it needs to be specified externally using std::function.
 
 namespace lua {
 
+inline void assert_arguments(lua_State* const state, const unsigned int expected)
+{
+    if (lua::size(state) >= expected) {
+        return;
+    }
+
+    std::stringstream msg;
+    msg << "Function expects at least "
+        << expected
+        << " argument" << (expected == 1 ? "" : "s");
+    if (lua::size(state) > 1) {
+        msg << " but only " << lua::size(state) << " were given";
+    } else if (lua::size(state) > 0) {
+        msg << " but only " << lua::size(state) << " was given";
+    } else {
+        msg << " but none were given";
+    }
+    throw lua::error(msg.str());
+}
+
 template <typename RV, typename... Args>
 int invoke_callable(lua_State* const state)
 {
-    auto wrapped = lua::get<std::function<RV(Args...)>>(
+    auto wrapped = lua::get<std::function<RV(Args...)>*>(
         state, lua_upvalueindex(1)
     );
 
-    if (lua::size(state) < sizeof...(Args)) {
-        std::stringstream msg;
-        msg << "Function expects at least "
-            << sizeof...(Args)
-            << " argument" << (sizeof...(Args) == 1 ? "" : "s");
-        if (lua::size(state) > 1) {
-            msg << " but only " << lua::size(state) << " were given";
-        } else if (lua::size(state) > 0) {
-            msg << " but only " << lua::size(state) << " was given";
-        } else {
-            msg << " but none were given";
-        }
-        throw lua::error(msg.str());
-    }
+    lua::assert_arguments(state, sizeof...(Args));
 
     lua::index index(state, 1);
-    return Invoke<decltype(wrapped), RV, Args..., ArgStop>::template invoke<>(wrapped, index);
+    return Invoke<std::function<RV(Args...)>, RV, Args..., ArgStop>::template invoke<>(*wrapped, index);
+}
+
+// Function and method pointers are trivially copyable, so they are saved
+// directly in a plain userdata, without a metatable, rather than being
+// wrapped in a std::function. Calling them needs no copies or allocations.
+template <typename Pointer>
+void push_pointer_upvalue(lua_State* const state, Pointer pointer)
+{
+    new (lua_newuserdata(state, sizeof(Pointer))) Pointer(pointer);
+}
+
+template <typename Pointer>
+const Pointer& get_pointer_upvalue(lua_State* const state)
+{
+    return *static_cast<Pointer*>(lua_touserdata(state, lua_upvalueindex(1)));
+}
+
+template <typename RV, typename... Args>
+int invoke_function_pointer(lua_State* const state)
+{
+    auto func = lua::get_pointer_upvalue<RV(*)(Args...)>(state);
+
+    lua::assert_arguments(state, sizeof...(Args));
+
+    lua::index index(state, 1);
+    return Invoke<RV(*)(Args...), RV, Args..., ArgStop>::template invoke<>(func, index);
+}
+
+template <typename Method, typename RV, typename Object, typename... Args>
+int invoke_method_pointer(lua_State* const state)
+{
+    auto method = std::mem_fn(lua::get_pointer_upvalue<Method>(state));
+
+    lua::assert_arguments(state, sizeof...(Args) + 1);
+
+    lua::index index(state, 1);
+    return Invoke<decltype(method), RV, Object*, Args..., ArgStop>::template invoke<>(method, index);
 }
 
 template <typename RV, typename... Args>
@@ -320,7 +462,8 @@ struct Push<RV(*)(Args...)>
 {
     static void push(lua_State* const state, RV(*func)(Args...))
     {
-        lua::push(state, std::function<RV(Args...)>(func));
+        lua::push_pointer_upvalue(state, func);
+        lua_pushcclosure(state, invoke_function_pointer<RV, Args...>, 1);
     }
 };
 
@@ -329,9 +472,8 @@ struct Push<RV(Object::*)(Args...)>
 {
     static void push(lua_State* const state, RV(Object::* func)(Args...))
     {
-        lua::push(state, std::function<RV(Object*, Args...)>(
-            std::mem_fn(func)
-        ));
+        lua::push_pointer_upvalue(state, func);
+        lua_pushcclosure(state, invoke_method_pointer<RV(Object::*)(Args...), RV, Object, Args...>, 1);
     }
 };
 
@@ -340,33 +482,42 @@ struct Push<RV(Object::*)(Args...) const>
 {
     static void push(lua_State* const state, RV(Object::* func)(Args...) const)
     {
-        lua::push(state, std::function<RV(Object*, Args...)>(
-            std::mem_fn(func)
-        ));
+        lua::push_pointer_upvalue(state, func);
+        lua_pushcclosure(state, invoke_method_pointer<RV(Object::*)(Args...) const, RV, Object, Args...>, 1);
     }
 };
 
 template <typename RV, typename... Args>
 struct Push<std::function<RV(Args...)>>
 {
-    static void push(lua_State* const state, const std::function<RV(Args...)>& callable)
+    template <class Callable>
+    static void push(lua_State* const state, Callable&& callable)
     {
-        Construct<std::function<RV(Args...)>>::construct(state, callable);
+        Construct<std::function<RV(Args...)>>::construct(state, std::forward<Callable>(callable));
         lua_pushcclosure(state, invoke_callable<RV, Args...>, 1);
     }
 };
 
+template <typename RV>
+int invoke_state_function(lua_State* const state)
+{
+    auto func = lua::get_pointer_upvalue<RV(*)(lua_State* const)>(state);
+    try {
+        return lua::push_returns(state, func(state));
+    } catch (lua::error& ex) {
+        lua::push(state, ex);
+        lua_error(state);
+        throw std::logic_error("lua_error must never return");
+    }
+}
+
 template <typename RV>
 struct Push<RV(*)(lua_State* const)>
 {
     static void push(lua_State* const state, RV(*func)(lua_State* const))
     {
-        lua::push(state, lua::callable([=](lua_State* const state) {
-            lua::push(state, func(state));
-            lua_replace(state, 1);
-            lua_settop(state, 1);
-            return 1;
-        }));
+        lua::push_pointer_upvalue(state, func);
+        lua_pushcclosure(state, invoke_state_function<RV>, 1);
     }
 };
 
@@ -376,10 +527,7 @@ struct Push<std::function<RV(lua_State* const)>>
     static void push(lua_State* const state, const std::function<RV(lua_State* const)>& func)
     {
         lua::push(state, lua::callable([=](lua_State* const state) {
-            lua::push(state, func(state));
-            lua_replace(state, 1);
-            lua_settop(state, 1);
-            return 1;
+            return lua::push_returns(state, func(state));
         }));
     }
 };
@@ -389,9 +537,11 @@ struct Metatable<std::function<Func>>
 {
     static constexpr const char* name = "std::function";
 
+    // Each signature has its own cached metatable, since metatables are
+    // cached by type rather than by name.
     static bool metatable(const lua::index& table, void* const value)
     {
-        return false;
+        return true;
     }
 };
 
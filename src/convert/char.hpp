@@ -8,7 +8,7 @@ namespace lua {
 template <>
 struct Push<char>
 {
-    static void push(lua_State* const state, char& source)
+    static void push(lua_State* const state, const char& source)
     {
         lua_pushlstring(state, &source, 1);
     }
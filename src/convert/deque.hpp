@@ -0,0 +1,54 @@
+#ifndef LUACXX_CONVERT_DEQUE_INCLUDED
+#define LUACXX_CONVERT_DEQUE_INCLUDED
+
+#include "vector.hpp"
+
+#include <deque>
+
+/*
+
+=head1 NAME
+
+convert/deque.hpp - support for std::deque as a Lua array
+
+=head1 SYNOPSIS
+
+    #include <luacxx/convert/deque.hpp>
+
+    std::deque<int> history;
+    lua::store(history, env["history"]);
+
+=head1 DESCRIPTION
+
+Deques are pushed as new tables, and tables are stored by appending their array
+part to the deque, using the same conversions as std::vector.
+
+*/
+
+namespace lua {
+
+template <class T, class Allocator>
+struct Push<std::deque<T, Allocator>>
+{
+    static void push(lua_State* const state, const std::deque<T, Allocator>& source)
+    {
+        lua::push_sequence(state, source.begin(), source.end(), source.size());
+    }
+};
+
+template <class T, class Allocator>
+struct Store<std::deque<T, Allocator>>
+{
+    static void store(std::deque<T, Allocator>& destination, const lua::index& source)
+    {
+        auto num_elements = lua::sequence_length(source, "std::deque<T>");
+        auto target_index = destination.size();
+        destination.resize(target_index + num_elements);
+
+        lua::store_sequence(destination.begin() + target_index, source, num_elements);
+    }
+};
+
+} // namespace lua
+
+#endif // LUACXX_CONVERT_DEQUE_INCLUDED
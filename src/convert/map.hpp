@@ -0,0 +1,90 @@
+#ifndef LUACXX_CONVERT_MAP_INCLUDED
+#define LUACXX_CONVERT_MAP_INCLUDED
+
+#include "../stack.hpp"
+#include "../table_builder.hpp"
+#include "../table_view.hpp"
+
+#include <map>
+
+/*
+
+=head1 NAME
+
+convert/map.hpp - support for std::map as a Lua table
+
+=head1 SYNOPSIS
+
+    #include <luacxx/convert/map.hpp>
+
+    std::map<std::string, int> sizes { { "width", 640 }, { "height", 480 } };
+    env["sizes"] = sizes;
+
+    std::map<std::string, int> from_lua;
+    lua::store(from_lua, env["sizes"]);
+
+=head1 DESCRIPTION
+
+Maps are pushed as new tables, presized for their entries and filled using a
+lua::table_builder. Tables are stored by clearing the map, and then setting
+each of their keys using a lua::table_map_view, so the map holds only the
+table's fields.
+
+The same conversions are used for std::unordered_map, QHash, and QMap, in
+convert/unordered_map.hpp, Qt5Core/QHash.hpp, and Qt5Core/QMap.hpp.
+
+=head4 lua::push_map(state, begin, end, size)
+
+Pushes a new table containing the given range of key and value pairs.
+
+=head4 lua::store_map(destination, source)
+
+Clears destination, then sets destination[key] = value for each field of the
+table at source.
+
+*/
+
+namespace lua {
+
+template <class Iterator>
+void push_map(lua_State* const state, Iterator begin, const Iterator end, const size_t size)
+{
+    lua::table_builder table(state, 0, size);
+    for (; begin != end; ++begin) {
+        table.set(begin->first, begin->second);
+    }
+}
+
+template <class Map>
+void store_map(Map& destination, const lua::index& source)
+{
+    typedef typename Map::key_type key_type;
+    typedef typename Map::mapped_type mapped_type;
+
+    destination.clear();
+    for (auto pair : lua::table_map_view<key_type, mapped_type>(source)) {
+        destination[std::move(pair.first)] = std::move(pair.second);
+    }
+}
+
+template <class K, class V, class Compare, class Allocator>
+struct Push<std::map<K, V, Compare, Allocator>>
+{
+    static void push(lua_State* const state, const std::map<K, V, Compare, Allocator>& source)
+    {
+        lua::push_map(state, source.begin(), source.end(), source.size());
+    }
+};
+
+template <class K, class V, class Compare, class Allocator>
+struct Store<std::map<K, V, Compare, Allocator>>
+{
+    static void store(std::map<K, V, Compare, Allocator>& destination, const lua::index& source)
+    {
+        lua::store_map(destination, source);
+    }
+};
+
+} // namespace lua
+
+#endif // LUACXX_CONVERT_MAP_INCLUDED
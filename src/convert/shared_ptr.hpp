@@ -14,12 +14,11 @@ struct Metatable<std::shared_ptr<T>>
 
     static bool metatable(const lua::index& mt, std::shared_ptr<T>* const source)
     {
+        // Cacheable whenever the pointee's metatable is.
         if (source != nullptr) {
-            Metatable<T>::metatable(mt, source->get());
-        } else {
-            Metatable<T>::metatable(mt, nullptr);
+            return Metatable<T>::metatable(mt, source->get());
         }
-        return false;
+        return Metatable<T>::metatable(mt, nullptr);
     }
 };
 
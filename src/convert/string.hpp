@@ -5,14 +5,59 @@
 
 #include <string>
 
+#if __cplusplus >= 201703L
+#include <string_view>
+#define LUACXX_HAVE_STRING_VIEW 1
+#endif
+
+/*
+
+=head1 NAME
+
+convert/string.hpp - support for std::string and std::string_view
+
+=head1 SYNOPSIS
+
+    #include <luacxx/convert/string.hpp>
+
+    lua::push(state, std::string("No\0time", 7));
+    auto payload = lua::get<std::string>(state, -1);
+    assert(payload.size() == 7);
+
+=head1 DESCRIPTION
+
+Strings are converted using their length, rather than searching for a
+terminating NUL, so they can hold binary data like messages, hashes, or image
+bytes.
+
+=head4 lua::push<std::string>, lua::get<std::string>
+
+Copies the string's bytes into or out of Lua. Numbers are read as their string
+form, and other values are read as an empty string.
+
+lua::get<const std::string&> returns a new std::string, since Lua doesn't
+store its strings as std::string.
+
+=head4 lua::push<std::string_view>, lua::get<std::string_view>
+
+When compiled as C++17, std::string_view can be used to read a Lua string
+without copying it. The view points directly into Lua's memory, so it is only
+valid while the string remains on the stack.
+
+    auto view = lua::get<std::string_view>(state, 1);
+
+Like lua_tolstring, this converts a number to a string in place.
+
+*/
+
 namespace lua {
 
 template <>
 struct Push<std::string>
 {
-    static void push(lua_State* const state, std::string& source)
+    static void push(lua_State* const state, const std::string& source)
     {
-        lua::push(state, source.c_str());
+        lua_pushlstring(state, source.data(), source.size());
     }
 };
 
@@ -21,7 +66,20 @@ struct Store<std::string>
 {
     static void store(std::string& destination, const lua::index& source)
     {
-        destination = lua::get<const char*>(source);
+        if (source.type().string()) {
+            size_t len = 0;
+            auto data = lua_tolstring(source.state(), source.pos(), &len);
+            destination.assign(data, len);
+        } else if (source.type().number()) {
+            // Convert a copy, so the original stays a number
+            lua_pushvalue(source.state(), source.pos());
+            size_t len = 0;
+            auto data = lua_tolstring(source.state(), -1, &len);
+            destination.assign(data, len);
+            lua_pop(source.state(), 1);
+        } else {
+            destination.clear();
+        }
     }
 };
 
@@ -34,6 +92,44 @@ struct Get<const std::string&>
     }
 };
 
+#ifdef LUACXX_HAVE_STRING_VIEW
+
+template <>
+struct Push<std::string_view>
+{
+    static void push(lua_State* const state, const std::string_view& source)
+    {
+        lua_pushlstring(state, source.data(), source.size());
+    }
+};
+
+template <>
+struct Store<std::string_view>
+{
+    static void store(std::string_view& destination, const lua::index& source)
+    {
+        if (!source.type().string() && !source.type().number()) {
+            destination = std::string_view();
+            return;
+        }
+
+        size_t len = 0;
+        auto data = lua_tolstring(source.state(), source.pos(), &len);
+        destination = std::string_view(data, len);
+    }
+};
+
+template <>
+struct Get<const std::string_view&>
+{
+    static std::string_view get(const lua::index& source)
+    {
+        return lua::Get<std::string_view>::get(source);
+    }
+};
+
+#endif // LUACXX_HAVE_STRING_VIEW
+
 } // namespace lua
 
 #endif // LUACXX_CONVERT_STRING_INCLUDED
@@ -0,0 +1,50 @@
+#ifndef LUACXX_CONVERT_UNORDERED_MAP_INCLUDED
+#define LUACXX_CONVERT_UNORDERED_MAP_INCLUDED
+
+#include "map.hpp"
+
+#include <unordered_map>
+
+/*
+
+=head1 NAME
+
+convert/unordered_map.hpp - support for std::unordered_map as a Lua table
+
+=head1 SYNOPSIS
+
+    #include <luacxx/convert/unordered_map.hpp>
+
+    std::unordered_map<std::string, double> prices;
+    lua::store(prices, env["prices"]);
+
+=head1 DESCRIPTION
+
+Unordered maps are pushed as new tables, and tables are stored by setting each
+of their keys in the map, using the same conversions as std::map.
+
+*/
+
+namespace lua {
+
+template <class K, class V, class Hash, class KeyEqual, class Allocator>
+struct Push<std::unordered_map<K, V, Hash, KeyEqual, Allocator>>
+{
+    static void push(lua_State* const state, const std::unordered_map<K, V, Hash, KeyEqual, Allocator>& source)
+    {
+        lua::push_map(state, source.begin(), source.end(), source.size());
+    }
+};
+
+template <class K, class V, class Hash, class KeyEqual, class Allocator>
+struct Store<std::unordered_map<K, V, Hash, KeyEqual, Allocator>>
+{
+    static void store(std::unordered_map<K, V, Hash, KeyEqual, Allocator>& destination, const lua::index& source)
+    {
+        lua::store_map(destination, source);
+    }
+};
+
+} // namespace lua
+
+#endif // LUACXX_CONVERT_UNORDERED_MAP_INCLUDED
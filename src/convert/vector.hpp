@@ -5,46 +5,244 @@
 
 #include <vector>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+
+/*
+
+=head1 NAME
+
+convert/vector.hpp - support for std::vector as a Lua array
+
+=head1 SYNOPSIS
+
+    #include <luacxx/convert/vector.hpp>
+
+    std::vector<double> samples(1000000);
+    env["samples"] = samples;
+
+    std::vector<double> from_lua;
+    lua::store(from_lua, env["samples"]);
+
+=head1 DESCRIPTION
+
+Vectors are pushed as new tables, and tables are stored by appending their
+array part to the vector.
+
+Vectors of numbers and booleans have a faster path, since they're often very
+large: the table or vector is sized once, and each element is converted with
+the Lua API directly, rather than through lua::push and lua::store. Elements
+that aren't numbers, like enumerations pushed as userdata, still go through
+lua::store.
+
+The same conversions are used for std::array and std::deque, in
+convert/array.hpp and convert/deque.hpp.
+
+=head4 lua::push_sequence(state, begin, end, size)
+
+Pushes a new table containing the given range of values.
+
+=head4 lua::store_sequence(destination, source, size)
+
+Stores the first size values of the table at source into successive positions
+of the destination iterator.
+
+*/
 
 namespace lua {
 
+// Converts one element of a sequence. The generic version uses lua::push and
+// lua::store; arithmetic types skip them.
+template <class T, class Enable = void>
+struct SequenceElement
+{
+    static void push(lua_State* const state, const T& source)
+    {
+        lua::push(state, source);
+    }
+
+    static void store(T& destination, lua_State* const state, const int pos)
+    {
+        lua::store(destination, state, pos);
+    }
+};
+
 template <class T>
-struct Push<std::vector<T>>
+struct SequenceElement<T, typename std::enable_if<
+    std::is_integral<T>::value && std::is_signed<T>::value && !std::is_same<T, char>::value
+    && sizeof(T) <= sizeof(lua_Integer)
+>::type>
 {
-    static void push(lua_State* const state, const std::vector<T>& source)
+    static void push(lua_State* const state, const T& source)
     {
-        // Create a new table and get an absolute index
-        lua_createtable(state, source.size(), 0);
+        lua_pushinteger(state, source);
+    }
 
-        // Populate the table with each value in source
-        for (int i = 0; i < source.size(); ++i) {
-            lua::push(state, source[i]);
-            lua_rawseti(state, -2, i + 1);
+    template <class Destination>
+    static void store(Destination&& destination, lua_State* const state, const int pos)
+    {
+        int isnum = 0;
+        auto value = lua_tointegerx(state, pos, &isnum);
+        if (!isnum) {
+            T sink = T();
+            lua::store(sink, state, pos);
+            destination = sink;
+            return;
         }
+        destination = static_cast<T>(value);
     }
 };
 
 template <class T>
-struct Store<std::vector<T>>
+struct SequenceElement<T, typename std::enable_if<
+    std::is_integral<T>::value && std::is_unsigned<T>::value
+    && !std::is_same<T, bool>::value && !std::is_same<T, char>::value
+    && sizeof(T) <= sizeof(lua_Unsigned)
+>::type>
 {
-    static void store(std::vector<T>& destination, const lua::index& source)
+    static void push(lua_State* const state, const T& source)
     {
-        if (!source || !source.type().table()) {
-            std::stringstream str;
-            str << "Lua stack value at position " << source.pos();
-            str << " must be a table, if it is to be converted to a std::vector<T>";
-            throw lua::error(str.str());
+        lua_pushunsigned(state, source);
+    }
+
+    template <class Destination>
+    static void store(Destination&& destination, lua_State* const state, const int pos)
+    {
+        int isnum = 0;
+        auto value = lua_tounsignedx(state, pos, &isnum);
+        if (!isnum) {
+            T sink = T();
+            lua::store(sink, state, pos);
+            destination = sink;
+            return;
         }
+        destination = static_cast<T>(value);
+    }
+};
 
-        auto num_elements = lua_rawlen(source.state(), source.pos());
-        auto target_index = destination.size();
-        destination.resize(destination.size() + num_elements);
+// Integers wider than Lua's, like uint64_t when lua_Unsigned has 32 bits, are
+// converted through lua_Number, so they aren't truncated to Lua's width.
+template <class T>
+struct SequenceElement<T, typename std::enable_if<
+    std::is_integral<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, char>::value
+    && (sizeof(T) > (std::is_signed<T>::value ? sizeof(lua_Integer) : sizeof(lua_Unsigned)))
+>::type>
+{
+    static void push(lua_State* const state, const T& source)
+    {
+        lua_pushnumber(state, static_cast<lua_Number>(source));
+    }
 
-        for (int i = 1; i <= num_elements; ++i, ++target_index) {
-            lua_rawgeti(source.state(), source.pos(), i);
-            lua::store(destination[target_index], source.state(), -1);
-            lua_pop(source.state(), 1);
+    template <class Destination>
+    static void store(Destination&& destination, lua_State* const state, const int pos)
+    {
+        int isnum = 0;
+        auto value = lua_tonumberx(state, pos, &isnum);
+        if (!isnum) {
+            T sink = T();
+            lua::store(sink, state, pos);
+            destination = sink;
+            return;
         }
+        destination = lua::clamp_number<T>(value);
+    }
+};
+
+template <class T>
+struct SequenceElement<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+    static void push(lua_State* const state, const T& source)
+    {
+        lua_pushnumber(state, source);
+    }
+
+    template <class Destination>
+    static void store(Destination&& destination, lua_State* const state, const int pos)
+    {
+        destination = static_cast<T>(lua_tonumber(state, pos));
+    }
+};
+
+template <>
+struct SequenceElement<bool>
+{
+    static void push(lua_State* const state, const bool& source)
+    {
+        lua_pushboolean(state, source);
+    }
+
+    // Also accepts std::vector<bool>'s proxy references.
+    template <class Destination>
+    static void store(Destination&& destination, lua_State* const state, const int pos)
+    {
+        destination = lua_toboolean(state, pos) != 0;
+    }
+};
+
+template <class Iterator>
+void push_sequence(lua_State* const state, Iterator begin, const Iterator end, const size_t size)
+{
+    typedef typename std::iterator_traits<Iterator>::value_type value_type;
+
+    // Lua's table indices are ints, so check the size once up front.
+    if (size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        throw lua::error("lua::push_sequence: Too many values for a Lua table");
+    }
+    lua_createtable(state, static_cast<int>(size), 0);
+
+    int i = 1;
+    for (; begin != end; ++begin, ++i) {
+        lua::SequenceElement<value_type>::push(state, *begin);
+        lua_rawseti(state, -2, i);
+    }
+}
+
+template <class Iterator>
+void store_sequence(Iterator destination, const lua::index& source, const size_t size)
+{
+    typedef typename std::iterator_traits<Iterator>::value_type value_type;
+
+    auto state = source.state();
+    auto pos = source.pos();
+    for (size_t i = 1; i <= size; ++i, ++destination) {
+        lua_rawgeti(state, pos, static_cast<int>(i));
+        lua::SequenceElement<value_type>::store(*destination, state, -1);
+        lua_pop(state, 1);
+    }
+}
+
+// Returns the length of the table at source, or throws if it isn't a table.
+inline size_t sequence_length(const lua::index& source, const char* const type_name)
+{
+    if (!source || !source.type().table()) {
+        std::stringstream str;
+        str << "Lua stack value at position " << source.pos();
+        str << " must be a table, if it is to be converted to a " << type_name;
+        throw lua::error(str.str());
+    }
+    return lua_rawlen(source.state(), source.pos());
+}
+
+template <class T, class Allocator>
+struct Push<std::vector<T, Allocator>>
+{
+    static void push(lua_State* const state, const std::vector<T, Allocator>& source)
+    {
+        lua::push_sequence(state, source.begin(), source.end(), source.size());
+    }
+};
+
+template <class T, class Allocator>
+struct Store<std::vector<T, Allocator>>
+{
+    static void store(std::vector<T, Allocator>& destination, const lua::index& source)
+    {
+        auto num_elements = lua::sequence_length(source, "std::vector<T>");
+        auto target_index = destination.size();
+        destination.resize(target_index + num_elements);
+
+        lua::store_sequence(destination.begin() + target_index, source, num_elements);
     }
 };
 
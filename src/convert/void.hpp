@@ -27,12 +27,12 @@ struct Store<void*>
         // It's a full userdata, so retrieve the underlying value
         auto userdata_block = lua::get<lua::userdata_block*>(source);
         if (!userdata_block) {
-            destination = nullptr;
+            // Not one of ours, so just return its memory.
+            destination = lua_touserdata(source.state(), source.pos());
             return;
-
         }
 
-        void* block = lua_touserdata(source.state(), source.pos());
+        void* block = userdata_block->data();
         switch (userdata_block->storage()) {
         case lua::userdata_storage::value:
             destination = block;
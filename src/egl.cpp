@@ -7,19 +7,11 @@
 
 #include <EGL/egl.h>
 
-int _eglInitialize(lua_State* const state)
+std::tuple<EGLBoolean, EGLint, EGLint> _eglInitialize(EGLDisplay display)
 {
     EGLint major, minor;
-
-    lua::push(state, eglInitialize(
-        lua::get<EGLDisplay>(state, 1),
-        &major,
-        &minor
-    ));
-
-    lua::push(state, major, minor);
-
-    return 3;
+    auto rv = eglInitialize(display, &major, &minor);
+    return std::make_tuple(rv, major, minor);
 }
 
 int _eglGetConfigs(lua_State* const state)
@@ -3,6 +3,8 @@
 
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace lua {
 
@@ -48,61 +50,158 @@ lua::error allows access to the traceback via traceback(). This value must be
 set manually, though throwing a lua::error that is eventually caught by this
 library will have its traceback set up automatically.
 
+The traceback is kept as a list of lua::stack_frames, copied from the Lua
+stack when the error was caught, and is only formatted as text when what() or
+traceback() is first called. Errors that are caught and discarded, without
+being described, never pay for that formatting. Capturing can be disabled for
+each state with lua::capture_tracebacks(state, false).
+
+=head4 lua::stack_frame
+
+One level of a traceback, as reported by lua_getinfo: the function's source,
+its name if known, the current and defining lines, and what kind of function
+it is: 'L' for Lua, 'C' for C, 'm' for a main chunk, or '.' for a gap where
+the middle of a deep stack was skipped. Text is copied into fixed buffers, so
+frames don't refer to the Lua state.
+
 */
 
+struct stack_frame
+{
+    // LUA_IDSIZE's default
+    static const size_t text_size = 60;
+
+    char source[text_size];
+    char name[text_size];
+    int line;
+    int defined;
+    char what;
+    bool tail_call;
+};
+
 class error : public std::runtime_error
 {
-    std::string _what;
-    unsigned int _traceback;
+    std::string _message;
+    std::string _traceback;
+    std::vector<lua::stack_frame> _frames;
+
+    // what() is formatted on demand
+    mutable std::string _what;
+    mutable bool _formatted;
+
+    static void append_frame(std::string& rv, const lua::stack_frame& frame)
+    {
+        rv += "\n\t";
+        if (frame.what == '.') {
+            rv += "...";
+            return;
+        }
+
+        rv += frame.source;
+        rv += ':';
+        if (frame.line > 0) {
+            rv += std::to_string(frame.line);
+            rv += ':';
+        }
+
+        if (frame.name[0]) {
+            rv += " in function '";
+            rv += frame.name;
+            rv += '\'';
+        } else if (frame.what == 'm') {
+            rv += " in main chunk";
+        } else if (frame.what == 'C') {
+            rv += " in ?";
+        } else {
+            rv += " in function <";
+            rv += frame.source;
+            rv += ':';
+            rv += std::to_string(frame.defined);
+            rv += '>';
+        }
+
+        if (frame.tail_call) {
+            rv += "\n\t(...tail calls...)";
+        }
+    }
 
 public:
     error(const std::string& what) :
         std::runtime_error("lua::error"),
-        _what(what),
-        _traceback(what.size())
+        _message(what),
+        _formatted(false)
     {
     }
 
     error() :
         std::runtime_error("lua::error"),
-        _what("An unspecified Lua error occurred."),
-        _traceback(_what.size())
+        _message("An unspecified Lua error occurred."),
+        _formatted(false)
     {
     }
 
     virtual const char* what() const noexcept override
     {
+        if (!_formatted) {
+            try {
+                _what = _message;
+                if (has_traceback()) {
+                    _what += "\n" + traceback();
+                }
+            } catch (...) {
+                return _message.c_str();
+            }
+            _formatted = true;
+        }
         return _what.c_str();
     }
 
     const bool has_traceback() const
     {
-        return _what.size() <= _traceback;
+        return !_traceback.empty() || !_frames.empty();
     }
 
     const std::string message() const
     {
-        if (!has_traceback()) {
-            return _what;
-        }
-        return _what.substr(0, _traceback);
+        return _message;
+    }
+
+    void set_message(const std::string& message)
+    {
+        _message = message;
+        _formatted = false;
     }
 
     const std::string traceback() const
     {
-        if (!has_traceback()) {
-            return "";
+        if (!_traceback.empty() || _frames.empty()) {
+            return _traceback;
+        }
+
+        std::string rv("stack traceback:");
+        for (auto& frame : _frames) {
+            append_frame(rv, frame);
         }
-        return _what.substr(_traceback + 1);
+        return rv;
+    }
+
+    const std::vector<lua::stack_frame>& frames() const
+    {
+        return _frames;
     }
 
     void set_traceback(const std::string& traceback)
     {
-        if (!has_traceback()) {
-            _what += "\n" + traceback;
-        } else {
-            _what = message() + "\n" + traceback;
-        }
+        _traceback = traceback;
+        _frames.clear();
+        _formatted = false;
+    }
+
+    void set_traceback(std::vector<lua::stack_frame>&& frames)
+    {
+        _traceback.clear();
+        _frames = std::move(frames);
+        _formatted = false;
     }
 };
 
@@ -0,0 +1,239 @@
+#ifndef LUACXX_FUNCTION_INCLUDED
+#define LUACXX_FUNCTION_INCLUDED
+
+#include "stack.hpp"
+#include "algorithm.hpp"
+#include "reference.hpp"
+
+#include <tuple>
+#include <utility>
+
+/*
+
+=head1 NAME
+
+lua::function - a typed handle for calling a Lua function from C++
+
+=head1 SYNOPSIS
+
+    #include <luacxx/function.hpp>
+    #include <luacxx/convert/string.hpp>
+    #include <luacxx/convert/numeric.hpp>
+
+    lua::run_string(env, "function greet(name, times) return ('Hello, ' .. name):rep(times) end");
+
+    lua::function<std::string(std::string, int)> greet(env["greet"]);
+    std::cout << greet("world", 2) << std::endl;
+    // Hello, worldHello, world
+
+    // Several results are returned as a tuple
+    lua::function<std::tuple<int, int>(int, int)> divmod(env["divmod"]);
+    int quotient, remainder;
+    std::tie(quotient, remainder) = divmod(7, 2);
+
+=head1 DESCRIPTION
+
+lua::call finds its callable each time it's called, by whatever path it was
+given, and leaves its result on the stack. A lua::function saves its callable
+once, in a registry slot, and each call pushes it from there, followed by the
+arguments as the declared types, and then converts exactly as many results as
+the return type expects. The stack is restored afterwards, even if the call or
+a conversion throws.
+
+Calls are protected as in lua::call, so Lua errors are thrown as lua::errors.
+
+Since the results are popped once converted, the return type should hold its
+own value, like std::string rather than const char*.
+
+=head4 lua::function<R(Args...)>(source)
+
+Saves the Lua function at the given source, which can be anything lua::push
+accepts, like a lua::index or env["name"]. The source must be a function, or
+nil to leave the handle empty.
+
+lua::functions can also be used as parameters of C++ functions bound to Lua,
+and pushed back to Lua as the function they hold.
+
+=head4 R operator()(Args... args)
+
+Calls the function. A return type of void ignores the results, and a
+std::tuple or std::pair converts several results in order. Missing results are
+converted from nil.
+
+=head4 explicit operator bool()
+
+Returns whether this handle holds a function.
+
+*/
+
+namespace lua {
+
+template <class T>
+struct Results
+{
+    static const int count = 1;
+
+    static T get(lua_State* const state, const int pos)
+    {
+        return lua::get<T>(state, pos);
+    }
+};
+
+template <>
+struct Results<void>
+{
+    static const int count = 0;
+
+    static void get(lua_State* const state, const int pos)
+    {
+    }
+};
+
+template <class... T>
+struct TupleResults;
+
+template <>
+struct TupleResults<>
+{
+    static std::tuple<> get(lua_State* const state, const int pos)
+    {
+        return std::tuple<>();
+    }
+};
+
+template <class First, class... Rest>
+struct TupleResults<First, Rest...>
+{
+    static std::tuple<First, Rest...> get(lua_State* const state, const int pos)
+    {
+        return std::tuple_cat(
+            std::tuple<First>(lua::get<First>(state, pos)),
+            TupleResults<Rest...>::get(state, pos + 1)
+        );
+    }
+};
+
+template <class... T>
+struct Results<std::tuple<T...>>
+{
+    static const int count = sizeof...(T);
+
+    static std::tuple<T...> get(lua_State* const state, const int pos)
+    {
+        return TupleResults<T...>::get(state, pos);
+    }
+};
+
+template <class First, class Second>
+struct Results<std::pair<First, Second>>
+{
+    static const int count = 2;
+
+    static std::pair<First, Second> get(lua_State* const state, const int pos)
+    {
+        return std::pair<First, Second>(
+            lua::get<First>(state, pos),
+            lua::get<Second>(state, pos + 1)
+        );
+    }
+};
+
+template <class Signature>
+class function;
+
+template <class R, class... Args>
+class function<R(Args...)>
+{
+    lua::reference _target;
+
+public:
+    function()
+    {
+    }
+
+    function(const function& other) = default;
+
+    // Copies from non-const handles, rather than treating them as sources
+    function(function& other) :
+        function(static_cast<const function&>(other))
+    {
+    }
+
+    function& operator=(const function& other) = default;
+
+    template <class Source>
+    function(Source source) :
+        _target(source.state())
+    {
+        set(source);
+    }
+
+    template <class Source>
+    void set(Source source)
+    {
+        auto state = source.state();
+        auto pushed = lua::push(state, source);
+        if (!pushed.type().function() && !pushed.type().nil()) {
+            lua_pop(state, 1);
+            throw lua::error("lua::function: source must be a Lua function");
+        }
+        _target.set_state(state);
+        _target = pushed;
+        lua_pop(state, 1);
+    }
+
+    lua_State* const state() const
+    {
+        return _target.state();
+    }
+
+    const lua::reference& target() const
+    {
+        return _target;
+    }
+
+    explicit operator bool() const
+    {
+        return static_cast<bool>(_target);
+    }
+
+    R operator()(Args... args) const
+    {
+        if (!_target) {
+            throw lua::error("lua::function: No function to call");
+        }
+        auto state = _target.state();
+        restore_top restore = { state, lua_gettop(state) };
+
+        auto handler = lua::push_error_handler(state);
+        lua_rawgeti(state, LUA_REGISTRYINDEX, _target.id());
+        lua::push(state, args...);
+        lua::invoke(lua::index(state, handler.pos() + 1));
+
+        // Make sure there's a value for each result, even if it's nil
+        lua_settop(state, handler.pos() + Results<R>::count);
+        return Results<R>::get(state, handler.pos() + 1);
+    }
+};
+
+template <class R, class... Args>
+struct Push<lua::function<R(Args...)>>
+{
+    static void push(lua_State* const state, const lua::function<R(Args...)>& source)
+    {
+        lua::push(state, source.target());
+    }
+};
+
+template <class R, class... Args>
+struct Store<lua::function<R(Args...)>>
+{
+    static void store(lua::function<R(Args...)>& destination, const lua::index& source)
+    {
+        destination.set(source);
+    }
+};
+
+} // namespace lua
+
+#endif // LUACXX_FUNCTION_INCLUDED
@@ -2,6 +2,7 @@
 #define LUACXX_GLOBAL_INCLUDED
 
 #include "stack.hpp"
+#include "key.hpp"
 
 #include <string>
 
@@ -12,16 +13,29 @@ class global
     lua_State* const _state;
     std::string _name;
 
+    // The interned name, or LUA_NOREF if the global was named by a string.
+    int _key;
+
 public:
     global(lua_State* const state, const std::string& name) :
         _state(state),
-        _name(name)
+        _name(name),
+        _key(LUA_NOREF)
+    {
+    }
+
+    global(lua_State* const state, const lua::key& name) :
+        _state(state),
+        _name(name.name()),
+        _key(name.id())
     {
+        name.check(state);
     }
 
     global(const lua::global& other) :
         _state(other._state),
-        _name(other._name)
+        _name(other._name),
+        _key(other._key)
     {
     }
 
@@ -35,6 +49,11 @@ public:
         return _name;
     }
 
+    int key() const
+    {
+        return _key;
+    }
+
     lua::type_info type() const
     {
         auto rv = lua::push(_state, *this).type();
@@ -45,7 +64,7 @@ public:
     template <class T>
     global& operator=(T source)
     {
-        lua::store(*this, lua::push(_state, source));
+        lua::store(*this, lua::push(_state, std::move(source)));
         lua_pop(_state, 1);
         return *this;
     }
@@ -81,7 +100,14 @@ struct Push<lua::global>
 {
     static void push(lua_State* const state, const lua::global& source)
     {
-        lua_getglobal(state, source.name().c_str());
+        if (source.key() == LUA_NOREF) {
+            lua_getglobal(state, source.name().c_str());
+            return;
+        }
+        lua_pushglobaltable(state);
+        lua_rawgeti(state, LUA_REGISTRYINDEX, source.key());
+        lua_gettable(state, -2);
+        lua_replace(state, -2);
     }
 };
 
@@ -90,8 +116,17 @@ struct Store<lua::global>
 {
     static void store(lua::global& global, const lua::index& source)
     {
+        auto state = global.state();
+        if (global.key() == LUA_NOREF) {
+            lua_pushvalue(source.state(), source.pos());
+            lua_setglobal(state, global.name().c_str());
+            return;
+        }
+        lua_pushglobaltable(state);
+        lua_rawgeti(state, LUA_REGISTRYINDEX, global.key());
         lua_pushvalue(source.state(), source.pos());
-        lua_setglobal(global.state(), global.name().c_str());
+        lua_settable(state, -3);
+        lua_pop(state, 1);
     }
 };
 
@@ -0,0 +1,73 @@
+#include "key.hpp"
+#include "error.hpp"
+
+namespace {
+
+// The registry address of the table mapping each interned string to its slot
+char key_slots;
+
+// Returns the slot for the string on the top of the stack, and pops it.
+int intern(lua_State* const state)
+{
+    lua_rawgetp(state, LUA_REGISTRYINDEX, &key_slots);
+    if (lua_isnil(state, -1)) {
+        lua_pop(state, 1);
+        lua_newtable(state);
+        lua_pushvalue(state, -1);
+        lua_rawsetp(state, LUA_REGISTRYINDEX, &key_slots);
+    }
+
+    lua_pushvalue(state, -2);
+    lua_rawget(state, -2);
+    if (lua_isnumber(state, -1)) {
+        int id = lua_tointeger(state, -1);
+        lua_pop(state, 3);
+        return id;
+    }
+    lua_pop(state, 1);
+
+    // Not seen before, so give the string its own slot
+    lua_pushvalue(state, -2);
+    int id = luaL_ref(state, LUA_REGISTRYINDEX);
+
+    lua_pushvalue(state, -2);
+    lua_pushinteger(state, id);
+    lua_rawset(state, -3);
+
+    lua_pop(state, 2);
+    return id;
+}
+
+// Returns the main thread of the given state, which every thread shares.
+lua_State* main_thread(lua_State* const state)
+{
+    lua_rawgeti(state, LUA_REGISTRYINDEX, LUA_RIDX_MAINTHREAD);
+    auto rv = lua_tothread(state, -1);
+    lua_pop(state, 1);
+    return rv;
+}
+
+} // namespace anonymous
+
+lua::key::key(lua_State* const state, const char* const name) :
+    _state(main_thread(state)),
+    _name(name)
+{
+    lua_pushstring(state, name);
+    _id = intern(state);
+}
+
+lua::key::key(lua_State* const state, const std::string& name) :
+    _state(main_thread(state)),
+    _name(name)
+{
+    lua_pushlstring(state, name.data(), name.size());
+    _id = intern(state);
+}
+
+void lua::key::check_thread(lua_State* const state) const
+{
+    if (main_thread(state) != _state) {
+        throw lua::error("lua::key: The key \"" + _name + "\" was created by another Lua state");
+    }
+}
@@ -0,0 +1,121 @@
+#ifndef LUACXX_KEY_INCLUDED
+#define LUACXX_KEY_INCLUDED
+
+#include "stack.hpp"
+
+#include <string>
+
+/*
+
+=head1 NAME
+
+lua::key - a string interned once per Lua state
+
+=head1 SYNOPSIS
+
+    #include <luacxx/key.hpp>
+
+    struct Config {
+        lua::key width;
+        lua::key height;
+
+        Config(lua_State* const state) :
+            width(state, "width"),
+            height(state, "height")
+        {
+        }
+    };
+
+    int area(lua_State* const state, const Config& keys)
+    {
+        auto config = lua::index(state, 1);
+        return config[keys.width].get<int>() * config[keys.height].get<int>();
+    }
+
+=head1 DESCRIPTION
+
+Whenever a string is pushed, Lua hashes it and looks it up in its string
+table, even if the same string was pushed a moment ago. Table access by name
+pays this for every lookup.
+
+A lua::key does this work once: the string is kept in a registry slot, and
+pushing the key only fetches that slot. Keys can be used anywhere a name
+is accepted, like lua::link, lua::table::get, or lua::thread's operator[].
+
+A key is a plain handle that can be freely copied. Each distinct string is
+given one slot per state, so constructing the same key twice reuses the first
+slot. The slots are kept until the state is closed. Keys must only be used
+with the state (or a thread of the state) that created them; using one with
+any other state throws a lua::error, rather than reading whatever that state
+keeps in the same slot.
+
+=head4 lua::key(state, name)
+
+Interns the given name in the state, and returns a key for it.
+
+=head4 int key.id()
+
+Returns the registry slot used by this key.
+
+=head4 lua_State* key.state(), const std::string& key.name()
+
+Returns the main thread of the state that created this key, and its name.
+
+=head4 void key.check(state)
+
+Throws a lua::error unless the given state, or the state it's a thread of,
+created this key. Pushing a key checks it first.
+
+*/
+
+namespace lua {
+
+class key
+{
+    lua_State* _state;
+    std::string _name;
+    int _id;
+
+    void check_thread(lua_State* const state) const;
+
+public:
+    key(lua_State* const state, const char* const name);
+    key(lua_State* const state, const std::string& name);
+
+    int id() const
+    {
+        return _id;
+    }
+
+    lua_State* const state() const
+    {
+        return _state;
+    }
+
+    const std::string& name() const
+    {
+        return _name;
+    }
+
+    void check(lua_State* const state) const
+    {
+        // Threads of the state are only looked up if needed
+        if (state != _state) {
+            check_thread(state);
+        }
+    }
+};
+
+template <>
+struct Push<lua::key>
+{
+    static void push(lua_State* const state, const lua::key& source)
+    {
+        source.check(state);
+        lua_rawgeti(state, LUA_REGISTRYINDEX, source.id());
+    }
+};
+
+} // namespace lua
+
+#endif // LUACXX_KEY_INCLUDED
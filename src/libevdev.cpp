@@ -44,16 +44,11 @@ int _libevdev_set_log_function(lua_State* const state)
     return 0;
 }
 
-int _libevdev_get_repeat(lua_State* const state)
+std::tuple<int, int, int> _libevdev_get_repeat(libevdev* const dev)
 {
     int delay, period;
-    lua::push(state, libevdev_get_repeat(
-        lua::get<libevdev*>(state, 1),
-        &delay,
-        &period
-    ));
-    lua::push(state, delay, period);
-    return 3;
+    auto rv = libevdev_get_repeat(dev, &delay, &period);
+    return std::make_tuple(rv, delay, period);
 }
 
 int luaopen_libevdev(lua_State* const state)
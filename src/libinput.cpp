@@ -9,17 +9,11 @@
 // http://wayland.freedesktop.org/libinput/doc/latest/group__event.html
 // http://wayland.freedesktop.org/libinput/doc/latest/libinput_8h.html
 
-int _libinput_device_get_size(lua_State* const state)
+std::tuple<double, double> _libinput_device_get_size(libinput_device* const device)
 {
     double width, height;
-    libinput_device_get_size(
-        lua::get<libinput_device*>(state, 1),
-        &width,
-        &height
-    );
-
-    lua::push(state, width, height);
-    return 2;
+    libinput_device_get_size(device, &width, &height);
+    return std::make_tuple(width, height);
 }
 
 int _libinput_log_set_handler(lua_State* const state)
@@ -14,6 +14,7 @@
 #include <llvm/IR/IRBuilder.h>
 
 #include "../../algorithm.hpp"
+#include "../../table_view.hpp"
 #include "../../thread.hpp"
 #include "../../convert/callable.hpp"
 #include "../../convert/numeric.hpp"
@@ -43,10 +44,15 @@ int IRBuilder_CreateAggregateRet(lua_State* const state)
     auto self = lua::get<IRBuilder<>*>(state, 1);
 
     if (lua_gettop(state) == 2 && lua_type(state, 2) == LUA_TTABLE) {
+        // CreateAggregateRet needs an array, so size it once from the table.
+        // The view's iterators are only input iterators, so the vector's
+        // range constructor wouldn't know the size in advance.
+        lua::table_view<Value*> view(lua::index(state, 2));
         std::vector<Value*> retVals;
-        lua::store(retVals, state, 2);
+        retVals.reserve(view.size());
+        retVals.assign(view.begin(), view.end());
         lua::push(state, self->CreateAggregateRet(
-            &retVals[0],
+            retVals.data(),
             retVals.size()
         ));
         return 1;
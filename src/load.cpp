@@ -119,6 +119,44 @@ lua::index lua::load_string(lua_State* const state, const char* input)
     return lua::index(state, -1);
 }
 
+lua::index lua::load_chunk(lua_State* const state, const std::string& chunk, const std::string& name)
+{
+    return do_post_load(state, luaL_loadbuffer(state, chunk.data(), chunk.size(), name.c_str()));
+}
+
+namespace {
+
+int write_dump(lua_State* const, const void* data, size_t size, void* destination)
+{
+    static_cast<std::string*>(destination)->append(static_cast<const char*>(data), size);
+    return 0;
+}
+
+} // namespace anonymous
+
+std::string lua::dump_bytecode(const lua::index& function)
+{
+    lua::assert_type("lua::dump_bytecode", lua::type::function, function);
+    if (lua_iscfunction(function.state(), function.pos())) {
+        throw lua::error("lua::dump_bytecode: C functions have no bytecode");
+    }
+
+    auto state = function.state();
+    lua_pushvalue(state, function.pos());
+    std::string rv;
+    auto result = lua_dump(state, write_dump, &rv
+        #if LUA_VERSION_NUM >= 503
+            // Account for the extra strip parameter introduced in 5.3
+            , 0
+        #endif
+    );
+    lua_pop(state, 1);
+    if (result != 0) {
+        throw lua::error("lua::dump_bytecode: Failed to write the function's bytecode");
+    }
+    return rv;
+}
+
 #ifdef HAVE_Qt5Core
 
 #include <QDir>
@@ -56,6 +56,29 @@ lua::index load_string(lua_State* const state, const char* input);
 
 /*
 
+=head2 lua::index lua::load_chunk(state, chunk, name)
+
+Compiles the given chunk, which can be Lua code or precompiled bytecode, such
+as from lua::dump_bytecode, and pushes a function that runs it. Unlike
+load_string, the chunk may contain embedded zeroes. The name is used in error
+messages.
+
+If compilation errors occur, a lua::error will be thrown.
+
+=head2 std::string lua::dump_bytecode(function)
+
+Returns the bytecode of the Lua function at the given index, so it can be
+loaded into other states without compiling it again. The bytecode keeps the
+function's upvalues, but not their values.
+
+It's not named lua::dump, since that prints the stack of a state.
+
+*/
+lua::index load_chunk(lua_State* const state, const std::string& chunk, const std::string& name = "chunk");
+std::string dump_bytecode(const lua::index& function);
+
+/*
+
 =head2 lua::index run_dir(state, const QDir&, bool recurse)
 
 Runs every file in the specified directory, optionally recursing into
@@ -217,25 +217,24 @@ int _NN_CMSG_LEN(lua_State* const state)
     return 1;
 }
 
-int _nn_symbol(lua_State* const state)
+std::pair<const char*, int> _nn_symbol(const int i)
 {
     int value;
-    auto name = nn_symbol(lua::get<int>(state, 1), &value);
-    lua::push(state, name, value);
-    return 2;
+    auto name = nn_symbol(i, &value);
+    return std::make_pair(name, value);
 }
 
 int void_tostring(lua_State* const state)
 {
     lua::push(state,
-        *static_cast<const char**>(lua_touserdata(state, 1))
+        *static_cast<const char**>(lua::get<void*>(state, 1))
     );
     return 1;
 }
 
 int _nn_freemsg(lua_State* const state)
 {
-    nn_freemsg(*reinterpret_cast<void**>(lua_touserdata(state, 1)));
+    nn_freemsg(*reinterpret_cast<void**>(lua::get<void*>(state, 1)));
     return 0;
 }
 
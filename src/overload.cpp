@@ -0,0 +1,220 @@
+#include "overload.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+enum class match {
+    none,
+    loose,
+    exact
+};
+
+match compare(const lua::parameter_type& parameter, const int type, const lua::userdata_type* const userdata)
+{
+    if (parameter.type == LUA_TNONE) {
+        // Anything could be converted, so prefer more specific candidates.
+        return match::loose;
+    }
+
+    if (parameter.type == type) {
+        // A userdata of any other class is never accepted, since it would be
+        // read as the parameter's class.
+        if (!parameter.userdata || parameter.userdata == userdata) {
+            return match::exact;
+        }
+        return match::none;
+    }
+
+    if (parameter.loose & lua::type_bit(type)) {
+        return match::loose;
+    }
+    return match::none;
+}
+
+} // namespace anonymous
+
+void lua::overload::insert(lua::overload_candidate&& candidate)
+{
+    auto arity = candidate.parameters.size();
+    if (arity > max_arity) {
+        std::stringstream str;
+        str << "lua::overload: Candidates can have at most " << max_arity
+            << " parameters, but " << arity << " were given";
+        throw std::logic_error(str.str());
+    }
+
+    if (_groups.size() <= arity) {
+        _groups.resize(arity + 1);
+    }
+    auto& group = _groups[arity];
+    if (group.candidates.size() >= max_candidates) {
+        std::stringstream str;
+        str << "lua::overload: At most " << max_candidates
+            << " candidates can take " << arity << " arguments";
+        throw std::logic_error(str.str());
+    }
+    group.candidates.push_back(std::move(candidate));
+    build(group);
+}
+
+void lua::overload::build(arity_group& group)
+{
+    group.positions.clear();
+    if (group.candidates.empty()) {
+        return;
+    }
+    group.all = group.candidates.size() == max_candidates ?
+        ~candidate_set(0) :
+        (candidate_set(1) << group.candidates.size()) - 1;
+
+    auto arity = group.candidates.front().parameters.size();
+    for (unsigned int pos = 0; pos < arity; ++pos) {
+        // Positions that accept anything in every candidate needn't be checked.
+        bool constrained = false;
+        for (auto& candidate : group.candidates) {
+            if (candidate.parameters[pos].type != LUA_TNONE) {
+                constrained = true;
+                break;
+            }
+        }
+        if (!constrained) {
+            continue;
+        }
+
+        position_table table;
+        table.pos = pos + 1;
+        for (auto& candidate : group.candidates) {
+            auto userdata = candidate.parameters[pos].userdata;
+            if (!userdata) {
+                continue;
+            }
+            bool listed = false;
+            for (auto& entry : table.classes) {
+                if (entry.first == userdata) {
+                    listed = true;
+                    break;
+                }
+            }
+            if (!listed) {
+                table.classes.emplace_back(userdata, accepted { 0, 0 });
+            }
+        }
+
+        for (int type = 0; type < lua::type_count; ++type) {
+            table.types[type] = accepted { 0, 0 };
+        }
+        for (unsigned int i = 0; i < group.candidates.size(); ++i) {
+            auto& parameter = group.candidates[i].parameters[pos];
+            auto bit = candidate_set(1) << i;
+
+            auto add = [&](accepted& entry, const int type, const lua::userdata_type* const userdata) {
+                switch (compare(parameter, type, userdata)) {
+                case match::exact:
+                    // An exact match is also acceptable loosely
+                    entry.exact |= bit;
+                    entry.loose |= bit;
+                    break;
+                case match::loose:
+                    entry.loose |= bit;
+                    break;
+                case match::none:
+                    break;
+                }
+            };
+
+            for (int type = 0; type < lua::type_count; ++type) {
+                add(table.types[type], type, nullptr);
+            }
+            for (auto& entry : table.classes) {
+                add(entry.second, LUA_TUSERDATA, entry.first);
+            }
+        }
+
+        group.positions.push_back(std::move(table));
+    }
+}
+
+const lua::overload_candidate* lua::overload::find(const arity_group& group, lua_State* const state)
+{
+    candidate_set exact = group.all;
+    candidate_set loose = group.all;
+
+    // Look up each argument's type once.
+    for (auto& table : group.positions) {
+        auto type = lua_type(state, table.pos);
+        const accepted* entry = &table.types[type];
+        if (type == LUA_TUSERDATA && !table.classes.empty() && lua_rawlen(state, table.pos) >= lua::userdata_block_size) {
+            auto userdata_block = static_cast<const lua::userdata_block*>(lua_touserdata(state, table.pos));
+            if (userdata_block->valid()) {
+                for (auto& class_entry : table.classes) {
+                    if (class_entry.first == userdata_block->type()) {
+                        entry = &class_entry.second;
+                        break;
+                    }
+                }
+            }
+        }
+        exact &= entry->exact;
+        loose &= entry->loose;
+        if (!loose) {
+            return nullptr;
+        }
+    }
+
+    // The lowest bit is the first candidate that was added.
+    auto chosen = exact ? exact : loose;
+    unsigned int index = 0;
+    while (!(chosen & 1)) {
+        chosen >>= 1;
+        ++index;
+    }
+    return &group.candidates[index];
+}
+
+int lua::overload::operator()(lua_State* const state) const
+{
+    unsigned int given = lua_gettop(state);
+
+    // Try the candidates that take every argument first, and then ignore
+    // extra trailing arguments.
+    auto groups = std::min<size_t>(given + 1, _groups.size());
+    for (auto arity = groups; arity-- > 0;) {
+        auto& group = _groups[arity];
+        if (group.candidates.empty()) {
+            continue;
+        }
+        auto candidate = find(group, state);
+        if (candidate) {
+            return (*candidate)(state);
+        }
+    }
+
+    std::stringstream str;
+    str << "lua::overload: No overload accepts the given " << given
+        << " argument" << (given == 1 ? "" : "s") << " (";
+    for (unsigned int i = 1; i <= given; ++i) {
+        if (i > 1) {
+            str << ", ";
+        }
+        auto name = lua::class_name(state, i);
+        str << (name.empty() ? lua_typename(state, lua_type(state, i)) : name);
+    }
+    str << ")";
+    throw lua::error(str.str());
+}
+
+int lua::invoke_overload(lua_State* const state)
+{
+    auto userdata_block = static_cast<lua::userdata_block*>(lua_touserdata(state, lua_upvalueindex(1)));
+    auto overloads = reinterpret_cast<lua::overload*>(userdata_block->data());
+    try {
+        return (*overloads)(state);
+    } catch (lua::error& ex) {
+        lua::push(state, ex);
+        lua_error(state);
+        throw std::logic_error("lua_error must never return");
+    }
+}
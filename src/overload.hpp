@@ -0,0 +1,418 @@
+#ifndef LUACXX_OVERLOAD_INCLUDED
+#define LUACXX_OVERLOAD_INCLUDED
+
+#include "stack.hpp"
+#include "convert/callable.hpp"
+#include "convert/string.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+
+=head1 NAME
+
+overload.hpp - overloaded C++ functions as a single Lua function
+
+=head1 SYNOPSIS
+
+    #include <luacxx/overload.hpp>
+
+    mt["drawArc"] = lua::overload()
+        .add<void(QPainter::*)(const QRectF&, int, int)>(&QPainter::drawArc)
+        .add<void(QPainter::*)(const QRect&, int, int)>(&QPainter::drawArc)
+        .add<void(QPainter::*)(int, int, int, int, int, int)>(&QPainter::drawArc);
+
+=head1 DESCRIPTION
+
+C++ overloads are chosen by the compiler, but Lua only has one function per
+name, so bindings used to check the arguments by hand to decide which C++
+function to call. lua::overload does this from a list of signatures instead.
+
+Candidates are grouped by their number of arguments. As each candidate is
+added, its group's dispatch table is rebuilt: for each argument position that
+any candidate constrains, the table maps each Lua type, and each userdata
+class named by a parameter, to the set of candidates that accept it, exactly
+or loosely. A call looks up the type of each of those arguments once, and
+intersects the sets, so it goes straight to the first candidate that matches
+exactly, or failing that, the first that matches loosely, without comparing
+candidates one by one.
+
+If no candidate takes as many arguments as were given, or none of them match,
+the groups with fewer arguments are tried in turn, so extra trailing arguments
+are ignored, as in hand-written bindings.
+
+An argument matches exactly if it has the Lua type its parameter expects, and
+for userdata, if it's of the parameter's class. A userdata of any other class
+never matches. Some parameters also accept other Lua types loosely: pointers
+accept nil and light userdata, enumerations accept numbers, and strings accept
+numbers. Parameters whose type has its own lua::Store accept anything, but only
+loosely.
+
+Function pointers, member function pointers, and std::functions can be added.
+Overloaded names need their signature given explicitly, as above. A function
+with default arguments can be added several times using std::function, once
+for each number of arguments.
+
+=head4 struct lua::Parameter<T>
+
+Describes the Lua value a parameter of type T expects. Specialize this if a
+type with its own lua::Store should prefer a specific Lua type:
+
+    template <>
+    struct Parameter<QString>
+    {
+        static lua::parameter_type get()
+        {
+            return lua::parameter_type(LUA_TSTRING);
+        }
+    };
+
+*/
+
+namespace lua {
+
+// The number of basic Lua types, from LUA_TNIL to LUA_TTHREAD.
+const int type_count = LUA_TTHREAD + 1;
+
+// Returns the bit for the given Lua type, for parameter_type::loose.
+inline unsigned int type_bit(const int type)
+{
+    return 1u << type;
+}
+
+struct parameter_type
+{
+    // The expected lua_type, or LUA_TNONE for any value.
+    int type;
+
+    // The expected class of a userdata, or nullptr for any userdata.
+    const lua::userdata_type* userdata;
+
+    // The other Lua types the parameter accepts loosely, as type_bits.
+    unsigned int loose;
+
+    parameter_type(const int type = LUA_TNONE, const lua::userdata_type* const userdata = nullptr, const unsigned int loose = 0) :
+        type(type),
+        userdata(userdata),
+        loose(loose)
+    {
+    }
+
+    bool operator==(const lua::parameter_type& other) const
+    {
+        return type == other.type && userdata == other.userdata && loose == other.loose;
+    }
+
+    bool operator!=(const lua::parameter_type& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+template <class T, class Enable = void>
+struct Parameter
+{
+    static lua::parameter_type get()
+    {
+        if (lua::is_userdata_store<T>::value) {
+            return lua::parameter_type(LUA_TUSERDATA, &lua::userdata_type_of<T>::value);
+        }
+
+        // It has its own conversion, so it could accept anything.
+        return lua::parameter_type();
+    }
+};
+
+template <class T>
+struct Parameter<T, typename std::enable_if<std::is_enum<T>::value>::type>
+{
+    static lua::parameter_type get()
+    {
+        return lua::parameter_type(LUA_TUSERDATA, &lua::userdata_type_of<T>::value,
+            lua::type_bit(LUA_TNUMBER)
+        );
+    }
+};
+
+template <class T>
+struct Parameter<T, typename std::enable_if<std::is_arithmetic<T>::value>::type>
+{
+    static lua::parameter_type get()
+    {
+        return lua::parameter_type(LUA_TNUMBER);
+    }
+};
+
+template <>
+struct Parameter<bool>
+{
+    static lua::parameter_type get()
+    {
+        return lua::parameter_type(LUA_TBOOLEAN);
+    }
+};
+
+template <class T>
+struct Parameter<T*>
+{
+    static lua::parameter_type get()
+    {
+        return lua::parameter_type(LUA_TUSERDATA,
+            &lua::userdata_type_of<typename std::remove_cv<T>::type>::value,
+            lua::type_bit(LUA_TNIL) | lua::type_bit(LUA_TLIGHTUSERDATA)
+        );
+    }
+};
+
+template <class T>
+struct Parameter<std::shared_ptr<T>>
+{
+    static lua::parameter_type get()
+    {
+        return lua::Parameter<T*>::get();
+    }
+};
+
+template <>
+struct Parameter<void*>
+{
+    static lua::parameter_type get()
+    {
+        return lua::parameter_type();
+    }
+};
+
+template <>
+struct Parameter<const char*>
+{
+    static lua::parameter_type get()
+    {
+        // Lua converts numbers to strings.
+        return lua::parameter_type(LUA_TSTRING, nullptr, lua::type_bit(LUA_TNUMBER));
+    }
+};
+
+template <>
+struct Parameter<std::string>
+{
+    static lua::parameter_type get()
+    {
+        // Lua converts numbers to strings.
+        return lua::parameter_type(LUA_TSTRING, nullptr, lua::type_bit(LUA_TNUMBER));
+    }
+};
+
+#ifdef LUACXX_HAVE_STRING_VIEW
+template <>
+struct Parameter<std::string_view>
+{
+    static lua::parameter_type get()
+    {
+        // Lua converts numbers to strings.
+        return lua::parameter_type(LUA_TSTRING, nullptr, lua::type_bit(LUA_TNUMBER));
+    }
+};
+#endif
+
+template <>
+struct Parameter<lua::index>
+{
+    static lua::parameter_type get()
+    {
+        return lua::parameter_type();
+    }
+};
+
+template <class T>
+lua::parameter_type parameter_type_of()
+{
+    return lua::Parameter<
+        typename std::remove_cv<typename std::remove_reference<T>::type>::type
+    >::get();
+}
+
+// One C++ signature of an overloaded function. The callee is kept behind a
+// plain function pointer, so dispatching doesn't go through std::function.
+struct overload_candidate
+{
+    std::vector<lua::parameter_type> parameters;
+    int (*invoke)(lua_State* const, const void* const);
+    std::shared_ptr<const void> callee;
+
+    int operator()(lua_State* const state) const
+    {
+        return invoke(state, callee.get());
+    }
+};
+
+// Builds the overload_candidate for each kind of callee.
+template <class Callee>
+struct OverloadCandidate;
+
+template <typename RV, typename... Args>
+struct OverloadCandidate<RV(*)(Args...)>
+{
+    typedef RV(*Callee)(Args...);
+
+    static int invoke(lua_State* const state, const void* const callee)
+    {
+        lua::index index(state, 1);
+        return Invoke<Callee, RV, Args..., ArgStop>::template invoke<>(
+            *static_cast<const Callee*>(callee), index
+        );
+    }
+
+    static lua::overload_candidate make(Callee func)
+    {
+        lua::overload_candidate candidate;
+        candidate.parameters = { lua::parameter_type_of<Args>()... };
+        candidate.invoke = invoke;
+        candidate.callee = std::make_shared<Callee>(func);
+        return candidate;
+    }
+};
+
+template <typename RV, typename... Args>
+struct OverloadCandidate<std::function<RV(Args...)>>
+{
+    typedef std::function<RV(Args...)> Callee;
+
+    static int invoke(lua_State* const state, const void* const callee)
+    {
+        lua::index index(state, 1);
+        return Invoke<Callee, RV, Args..., ArgStop>::template invoke<>(
+            *static_cast<const Callee*>(callee), index
+        );
+    }
+
+    static lua::overload_candidate make(const Callee& func)
+    {
+        lua::overload_candidate candidate;
+        candidate.parameters = { lua::parameter_type_of<Args>()... };
+        candidate.invoke = invoke;
+        candidate.callee = std::make_shared<Callee>(func);
+        return candidate;
+    }
+};
+
+template <typename Method, typename RV, typename Object, typename... Args>
+struct MethodCandidate
+{
+    static int invoke(lua_State* const state, const void* const callee)
+    {
+        auto method = std::mem_fn(*static_cast<const Method*>(callee));
+        lua::index index(state, 1);
+        return Invoke<decltype(method), RV, Object*, Args..., ArgStop>::template invoke<>(method, index);
+    }
+
+    static lua::overload_candidate make(Method func)
+    {
+        lua::overload_candidate candidate;
+        candidate.parameters = { lua::parameter_type_of<Object*>(), lua::parameter_type_of<Args>()... };
+        candidate.invoke = invoke;
+        candidate.callee = std::make_shared<Method>(func);
+        return candidate;
+    }
+};
+
+template <typename RV, typename Object, typename... Args>
+struct OverloadCandidate<RV(Object::*)(Args...)> :
+    public lua::MethodCandidate<RV(Object::*)(Args...), RV, Object, Args...>
+{
+};
+
+template <typename RV, typename Object, typename... Args>
+struct OverloadCandidate<RV(Object::*)(Args...) const> :
+    public lua::MethodCandidate<RV(Object::*)(Args...) const, RV, Object, Args...>
+{
+};
+
+class overload
+{
+public:
+    // The most arguments an overloaded function can take.
+    static const unsigned int max_arity = 16;
+
+    // The most candidates that can take the same number of arguments.
+    static const unsigned int max_candidates = 64;
+
+    typedef std::uint64_t candidate_set;
+
+    template <class Callee>
+    overload& add(Callee func)
+    {
+        insert(lua::OverloadCandidate<Callee>::make(func));
+        return *this;
+    }
+
+    // Invokes the candidate that best matches the arguments on the stack.
+    int operator()(lua_State* const state) const;
+
+private:
+    // The candidates that accept some kind of argument, as bits in the order
+    // the candidates were added.
+    struct accepted
+    {
+        candidate_set exact;
+        candidate_set loose;
+    };
+
+    // The dispatch table for one argument position.
+    struct position_table
+    {
+        unsigned int pos;
+
+        // For each Lua type, or a userdata of a class no parameter names
+        accepted types[lua::type_count];
+
+        // For each userdata class named by a parameter at this position
+        std::vector<std::pair<const lua::userdata_type*, accepted>> classes;
+    };
+
+    // The candidates that take the same number of arguments, and the table
+    // for each argument position any of them constrains.
+    struct arity_group
+    {
+        std::vector<lua::overload_candidate> candidates;
+        candidate_set all;
+        std::vector<position_table> positions;
+    };
+
+    void insert(lua::overload_candidate&& candidate);
+    static void build(arity_group& group);
+    static const lua::overload_candidate* find(const arity_group& group, lua_State* const state);
+
+    std::vector<arity_group> _groups;
+};
+
+template <>
+struct Metatable<lua::overload>
+{
+    static constexpr const char* name = "lua::overload";
+
+    static bool metatable(const lua::index& mt, lua::overload* const)
+    {
+        return true;
+    }
+};
+
+int invoke_overload(lua_State* const state);
+
+template <>
+struct Push<lua::overload>
+{
+    template <class Overload>
+    static void push(lua_State* const state, Overload&& overloads)
+    {
+        Construct<lua::overload>::construct(state, std::forward<Overload>(overloads));
+        lua_pushcclosure(state, invoke_overload, 1);
+    }
+};
+
+} // namespace lua
+
+#endif // LUACXX_OVERLOAD_INCLUDED
@@ -0,0 +1,72 @@
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+namespace {
+
+struct slice_result
+{
+    std::vector<lua::batch_error> errors;
+    std::exception_ptr exception;
+};
+
+void run_slice(lua::state_pool& pool, const size_t first, const size_t last, const std::function<void(lua_State* const, const size_t, const size_t)>& work, slice_result& result)
+{
+    try {
+        auto lease = pool.acquire();
+        work(lease, first, last);
+    } catch (lua::batch_error& ex) {
+        result.errors.push_back(ex);
+    } catch (...) {
+        result.exception = std::current_exception();
+    }
+}
+
+} // namespace anonymous
+
+void lua::parallel_slices(lua::state_pool& pool, const size_t count, const std::function<void(lua_State* const, const size_t, const size_t)>& work)
+{
+    if (count == 0) {
+        return;
+    }
+    auto slices = std::min(std::max<size_t>(pool.size(), 1), count);
+
+    std::vector<slice_result> results(slices);
+    std::vector<std::thread> threads;
+    threads.reserve(slices - 1);
+    try {
+        for (size_t i = 0; i < slices - 1; ++i) {
+            threads.emplace_back(run_slice,
+                std::ref(pool),
+                count * i / slices,
+                count * (i + 1) / slices,
+                std::cref(work),
+                std::ref(results[i])
+            );
+        }
+    } catch (...) {
+        // Wait for the slices that did start before giving up
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        throw;
+    }
+
+    run_slice(pool, count * (slices - 1) / slices, count, work, results[slices - 1]);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<lua::batch_error> errors;
+    for (auto& result : results) {
+        if (result.exception) {
+            std::rethrow_exception(result.exception);
+        }
+        errors.insert(errors.end(), result.errors.begin(), result.errors.end());
+    }
+    if (!errors.empty()) {
+        throw lua::parallel_error(errors);
+    }
+}
@@ -0,0 +1,161 @@
+#ifndef LUACXX_PARALLEL_INCLUDED
+#define LUACXX_PARALLEL_INCLUDED
+
+#include "stack.hpp"
+#include "batch.hpp"
+#include "state_pool.hpp"
+#include "thread.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+
+=head1 NAME
+
+lua::parallel_for, lua::parallel_map - call a Lua function for many values, using several states at once
+
+=head1 SYNOPSIS
+
+    #include <luacxx/parallel.hpp>
+    #include <luacxx/convert/numeric.hpp>
+    #include <luacxx/convert/vector.hpp>
+
+    // One state for each worker thread, each with the same code
+    lua::state_pool workers(std::thread::hardware_concurrency(), lua::chunk_initializer(
+        "function add_tax(price) return price * 1.08 end"
+    ));
+
+    std::vector<double> prices = load_prices();
+    auto taxed = lua::parallel_map<std::vector<double>>(workers, "add_tax", prices);
+
+    try {
+        lua::parallel_for(workers, "log_price", prices);
+    } catch (lua::parallel_error& ex) {
+        for (auto& error : ex.errors()) {
+            std::cerr << error.what() << std::endl;
+        }
+    }
+
+=head1 DESCRIPTION
+
+A Lua state can only be used by one thread at a time, so Lua work is spread
+across threads by giving each its own state. These helpers do that with a
+lua::state_pool: the values are split into one contiguous slice per state in
+the pool, and each slice is given to its own thread, which leases a state and
+calls the named global function for each of its values, as lua::map does. The
+calling thread runs the last slice itself, and then waits for the others.
+
+Since the states share nothing, the function is named rather than given, and
+each state must define it, usually from the pool's initializer. Values are
+pushed with lua::push, and results converted with lua::get, within each
+worker's state, so anything those accept can be given. The values are only
+read, and each result is written by one thread, so the range and container
+don't need to be locked.
+
+Each state is reset when its slice is finished, so the function shouldn't rely
+on globals it sets during the batch outliving it.
+
+Starting the threads and resetting the states costs more than a single
+lua::map of the same values does. On one core, or for cheap functions, these
+are slower than lua::map, so they only pay off when there are several cores
+and enough work to split between them.
+
+=head4 lua::parallel_for(pool, name, values)
+
+Calls the named function once for each value, ignoring its results.
+
+=head4 Container lua::parallel_map<Container>(pool, name, values)
+
+Calls the named function once for each value, and sets its first result,
+converted to the container's value_type, at the same position of the returned
+container. The container is created with a size, so its value_type must be
+default-constructible. Results are written from several threads at once, so
+containers that pack their elements together, like std::vector<bool>, are
+refused at compile time; use std::vector<char> or std::deque<bool> instead.
+
+=head4 lua::parallel_error
+
+Thrown once every slice is finished, if any calls failed. A slice stops at its
+first failed call, so there's at most one error for each slice. The error's
+message and traceback are the first failure's, and errors() returns every
+failure as a lua::batch_error, in order of position in the whole range.
+
+Other exceptions, like failed conversions, are rethrown as they are, once
+every slice is finished. If several slices threw them, only the first is
+rethrown.
+
+*/
+
+namespace lua {
+
+class parallel_error : public lua::error
+{
+    std::vector<lua::batch_error> _errors;
+
+public:
+    parallel_error(const std::vector<lua::batch_error>& errors) :
+        lua::error(errors.front()),
+        _errors(errors)
+    {
+        if (_errors.size() > 1) {
+            set_message(message() + " (and " + std::to_string(_errors.size() - 1) + " more)");
+        }
+    }
+
+    const std::vector<lua::batch_error>& errors() const
+    {
+        return _errors;
+    }
+};
+
+// Splits count values into a slice for each state in the pool, and calls work
+// with each slice's leased state and bounds from its own thread. The last slice
+// is run on the calling thread.
+void parallel_slices(lua::state_pool& pool, const size_t count, const std::function<void(lua_State* const, const size_t, const size_t)>& work);
+
+template <class Range>
+void parallel_for(lua::state_pool& pool, const std::string& name, const Range& values)
+{
+    auto begin = std::begin(values);
+    auto count = static_cast<size_t>(std::distance(begin, std::end(values)));
+
+    parallel_slices(pool, count, [&](lua_State* const state, const size_t first, const size_t last) {
+        lua::thread env(state);
+        lua::batch_invoke(state, env[name], std::next(begin, first), std::next(begin, last), [](const lua::index&, const size_t) {
+        }, first);
+    });
+}
+
+template <class Container, class Range>
+Container parallel_map(lua::state_pool& pool, const std::string& name, const Range& values)
+{
+    typedef typename Container::value_type value_type;
+
+    // Slices write their results from separate threads, so each element must
+    // be a separate object; std::vector<bool> packs several into each word.
+    static_assert(std::is_same<typename Container::reference, value_type&>::value,
+        "lua::parallel_map needs a container whose elements are separate objects, unlike std::vector<bool>");
+
+    auto begin = std::begin(values);
+    auto count = static_cast<size_t>(std::distance(begin, std::end(values)));
+
+    Container rv(count);
+    auto destination = std::begin(rv);
+    parallel_slices(pool, count, [&](lua_State* const state, const size_t first, const size_t last) {
+        lua::thread env(state);
+        auto result_iter = std::next(destination, first);
+        lua::batch_invoke(state, env[name], std::next(begin, first), std::next(begin, last), [&result_iter](const lua::index& result, const size_t) {
+            *result_iter++ = lua::get<value_type>(result);
+        }, first);
+    });
+    return rv;
+}
+
+} // namespace lua
+
+#endif // LUACXX_PARALLEL_INCLUDED
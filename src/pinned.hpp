@@ -0,0 +1,209 @@
+#ifndef LUACXX_PINNED_INCLUDED
+#define LUACXX_PINNED_INCLUDED
+
+#include "stack.hpp"
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+/*
+
+=head1 NAME
+
+lua::pinned - a path to a Lua value, resolved once
+
+=head1 SYNOPSIS
+
+    #include <luacxx/pinned.hpp>
+
+    int luaopen_Qt5Core_QCryptographicHash(lua_State* const state)
+    {
+        lua::thread env(state);
+
+        env["QCryptographicHash"] = lua::value::table;
+        lua::pinned t(env["QCryptographicHash"]);
+
+        t["Md4"] = QCryptographicHash::Md4;
+        t["Md5"] = QCryptographicHash::Md5;
+
+        return 0;
+    }
+
+=head1 DESCRIPTION
+
+Each use of a lua::link or lua::global walks its whole path again, so setting
+many fields through env["Foo"]["Bar"] looks up Foo and then Bar for every
+field.
+
+lua::pinned walks its path once, and saves the value it found in a registry
+slot. Using the pinned value, or any field of it, then starts from that slot.
+
+The saved value is not updated if the path is later changed to refer to a
+different value. Call invalidate() after changing it, and the path will be
+walked again the next time the pinned value is used.
+
+Copies of a lua::pinned share its slot, so they are cheap to make, and
+invalidating one invalidates them all. Like lua::reference, a lua::pinned must
+not outlive its Lua state.
+
+=head4 lua::pinned(source)
+
+Resolves the given source, which can be anything that can be pushed and has a
+state(), like a lua::global or lua::link.
+
+=head4 pinned[name]
+
+Returns a lua::link to a field of the pinned value.
+
+=head4 pinned.invalidate()
+
+Releases the saved value, so the path is resolved again on next use.
+
+=head4 bool pinned.resolved()
+
+Returns whether the pinned value currently has a saved value.
+
+*/
+
+namespace lua {
+
+// A registry slot owned by something else, such as a lua::pinned.
+class slot
+{
+    lua_State* _state;
+    int _id;
+
+public:
+    slot(lua_State* const state, const int id) :
+        _state(state),
+        _id(id)
+    {
+    }
+
+    lua_State* const state() const
+    {
+        return _state;
+    }
+
+    int id() const
+    {
+        return _id;
+    }
+};
+
+template <>
+struct Push<lua::slot>
+{
+    static void push(lua_State* const state, const lua::slot& source)
+    {
+        lua_rawgeti(state, LUA_REGISTRYINDEX, source.id());
+    }
+};
+
+class pinned
+{
+    // Shared by copies of a pinned value, so they all use the same slot.
+    struct resolution
+    {
+        lua_State* const state;
+        std::function<void(lua_State* const)> push_source;
+
+        // The slot holding the resolved value, or LUA_NOREF if it must be resolved
+        int id;
+
+        ~resolution()
+        {
+            if (id != LUA_NOREF) {
+                luaL_unref(state, LUA_REGISTRYINDEX, id);
+            }
+        }
+    };
+
+    std::shared_ptr<resolution> _resolution;
+
+public:
+    template <class Source, class = typename std::enable_if<
+        !std::is_same<typename std::decay<Source>::type, lua::pinned>::value
+    >::type>
+    pinned(const Source& source) :
+        _resolution(new resolution {
+            source.state(),
+            [source](lua_State* const state) {
+                lua::push(state, source);
+            },
+            LUA_NOREF
+        })
+    {
+        resolve();
+    }
+
+    lua_State* const state() const
+    {
+        return _resolution->state;
+    }
+
+    // Returns the slot of the resolved value, resolving it if needed.
+    int resolve() const
+    {
+        auto& resolution = *_resolution;
+        if (resolution.id == LUA_NOREF) {
+            resolution.push_source(resolution.state);
+            resolution.id = luaL_ref(resolution.state, LUA_REGISTRYINDEX);
+        }
+        return resolution.id;
+    }
+
+    bool resolved() const
+    {
+        return _resolution->id != LUA_NOREF;
+    }
+
+    void invalidate()
+    {
+        auto& resolution = *_resolution;
+        if (resolution.id != LUA_NOREF) {
+            luaL_unref(resolution.state, LUA_REGISTRYINDEX, resolution.id);
+            resolution.id = LUA_NOREF;
+        }
+    }
+
+    lua::type_info type() const
+    {
+        lua_rawgeti(state(), LUA_REGISTRYINDEX, resolve());
+        auto rv = lua::index(state(), -1).type();
+        lua_pop(state(), 1);
+        return rv;
+    }
+
+    template <class T>
+    lua::link<lua::slot, T> operator[](T name) const
+    {
+        return lua::link<lua::slot, T>(lua::slot(state(), resolve()), name);
+    }
+
+    template <class T>
+    T get() const
+    {
+        return lua::get<T>(*this);
+    }
+
+    template <class T>
+    operator T() const
+    {
+        return get<T>();
+    }
+};
+
+template <>
+struct Push<lua::pinned>
+{
+    static void push(lua_State* const state, const lua::pinned& source)
+    {
+        lua_rawgeti(state, LUA_REGISTRYINDEX, source.resolve());
+    }
+};
+
+} // namespace lua
+
+#endif // LUACXX_PINNED_INCLUDED
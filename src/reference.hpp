@@ -4,6 +4,8 @@
 #include "stack.hpp"
 #include "algorithm.hpp"
 
+#include <utility>
+
 /*
 
 =head1 NAME
@@ -154,6 +156,22 @@ auto get() -> decltype(lua::get<T>(*this))
 
 /*
 
+=head4 operator=(const lua::reference& other)
+
+Refers to the other reference's value, with a registry slot of its own.
+
+*/
+
+reference& operator=(const lua::reference& other)
+{
+    lua::reference copy(other);
+    std::swap(_state, copy._state);
+    std::swap(_id, copy._id);
+    return *this;
+}
+
+/*
+
 =head4 operator=(T source)
 
 */
@@ -0,0 +1,325 @@
+#ifndef LUACXX_SEQUENCE_VIEW_INCLUDED
+#define LUACXX_SEQUENCE_VIEW_INCLUDED
+
+#include "stack.hpp"
+#include "convert/callable.hpp"
+#include "convert/vector.hpp"
+
+#include <deque>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+
+=head1 NAME
+
+lua::sequence_view - a C++ container that Lua indexes in place
+
+=head1 SYNOPSIS
+
+    #include <luacxx/sequence_view.hpp>
+
+    std::vector<double> samples(1000000);
+    env["samples"] = lua::view(&samples);
+
+    lua::run_string(env, "samples[1] = 42");
+    lua::run_string(env, "for i, sample in ipairs(samples) do print(i, sample) end");
+    lua::run_string(env, "samples[#samples + 1] = 1");
+
+    // Views can also share ownership of their container
+    #include <luacxx/Qt5Gui/QPolygonF.hpp>
+    auto points = std::make_shared<QPolygonF>();
+    env["points"] = lua::view(points);
+
+=head1 DESCRIPTION
+
+Pushing a container like std::vector copies it into a new table, and storing
+the table copies it back, which is slow for large containers and leaves Lua
+with a copy rather than the container itself.
+
+A lua::sequence_view is instead a userdata that refers to the container.
+Indexing it from Lua reads or writes the container's elements directly, using
+Lua's 1-based indices, and # returns the container's current size. Assigning
+one past the end appends a new element, and ipairs() iterates over the
+elements. Nothing is copied until an element is read.
+
+Any container with size(), operator[], begin(), insert(), erase(), push_back(),
+and clear() can be viewed, including std::vector, std::deque, QVector, QList,
+and QPolygonF. Elements are converted like those of a pushed table, so
+elements that are userdata are copied when they're read.
+
+A view made from a pointer doesn't own its container, so the container must
+outlive the view, like any pointer pushed to Lua. A view made from a
+std::shared_ptr keeps its container alive, and lua::push_view keeps alive the
+userdata that holds the container.
+
+Bindings receive the container itself, without copying, by taking a
+lua::sequence_view<Container>& and calling container().
+
+=head4 lua::view(container*), lua::view(std::shared_ptr<container>)
+
+Returns a view of the given container, ready to be pushed.
+
+=head4 lua::push_view(state, container*, owner)
+
+Pushes a view of a container that lives within the value at the owner's
+position, usually a userdata, and keeps that value alive for as long as the
+view. Bindings use this to return views of their own members.
+
+=head4 LUACXX_SEQUENCE_VIEW_NAME(container)
+
+Views of each container type have their own class name, like
+"lua::sequence_view<std::vector<double>>", which is defined by this macro for
+std::vector and std::deque of numbers and strings. Use it at global scope to
+name views of other containers; views of an unnamed container still work, but
+aren't registered by name. A container's name must be defined before every
+use of its views, so it belongs in the header that declares the container's
+bindings, as Qt5Core/QVector.hpp and Qt5Gui/QPolygonF.hpp do.
+
+=head4 view:append(value), view:insert(index, value), view:remove(index)
+
+Adds or removes elements. insert() moves the element at index and those after
+it up by one.
+
+=head4 view:size(), view:clear()
+
+Returns the number of elements, or removes them all.
+
+=head4 view:table()
+
+Returns a new table containing the view's elements.
+
+*/
+
+namespace lua {
+
+template <class Container>
+class sequence_view
+{
+    std::shared_ptr<Container> _container;
+
+    size_t check_index(const lua_Integer index, const size_t limit) const
+    {
+        if (index < 1 || static_cast<size_t>(index) > limit) {
+            std::stringstream str;
+            str << "lua::sequence_view: Index " << index
+                << " is out of range for a container of size " << size();
+            throw lua::error(str.str());
+        }
+        return static_cast<size_t>(index) - 1;
+    }
+
+public:
+    typedef typename Container::value_type value_type;
+
+    explicit sequence_view(Container* const container) :
+        _container(container, [](Container* const) {})
+    {
+    }
+
+    explicit sequence_view(const std::shared_ptr<Container>& container) :
+        _container(container)
+    {
+    }
+
+    Container& container() const
+    {
+        return *_container;
+    }
+
+    size_t size() const
+    {
+        return _container->size();
+    }
+
+    // Sets the element at the 1-based index, or appends one past the end.
+    void set(const lua_Integer index, value_type value)
+    {
+        auto pos = check_index(index, size() + 1);
+        if (pos == size()) {
+            _container->push_back(std::move(value));
+            return;
+        }
+        (*_container)[pos] = std::move(value);
+    }
+
+    void append(value_type value)
+    {
+        _container->push_back(std::move(value));
+    }
+
+    void insert(const lua_Integer index, value_type value)
+    {
+        auto pos = check_index(index, size() + 1);
+        _container->insert(_container->begin() + pos, std::move(value));
+    }
+
+    void remove(const lua_Integer index)
+    {
+        auto pos = check_index(index, size());
+        _container->erase(_container->begin() + pos);
+    }
+
+    void clear()
+    {
+        _container->clear();
+    }
+};
+
+template <class Container>
+lua::sequence_view<Container> view(Container* const container)
+{
+    return lua::sequence_view<Container>(container);
+}
+
+template <class Container>
+lua::sequence_view<Container> view(const std::shared_ptr<Container>& container)
+{
+    return lua::sequence_view<Container>(container);
+}
+
+template <class Container>
+void push_view(lua_State* const state, Container* const container, const int owner)
+{
+    auto owner_pos = lua_absindex(state, owner);
+    lua::push(state, lua::view(container));
+
+    // A uservalue must be a table, so the owner is kept within one
+    lua_createtable(state, 1, 0);
+    lua_pushvalue(state, owner_pos);
+    lua_rawseti(state, -2, 1);
+    lua_setuservalue(state, -2);
+}
+
+template <class Container>
+int sequence_view_index(lua_State* const state)
+{
+    typedef typename Container::value_type value_type;
+    auto& view = lua::get<lua::sequence_view<Container>&>(state, 1);
+
+    if (lua_type(state, 2) == LUA_TNUMBER) {
+        auto index = lua_tointeger(state, 2);
+        if (index < 1 || static_cast<size_t>(index) > view.size()) {
+            lua_pushnil(state);
+            return 1;
+        }
+        lua::SequenceElement<value_type>::push(state, view.container()[index - 1]);
+        return 1;
+    }
+
+    // Not an element, so look for a method
+    lua_getmetatable(state, 1);
+    lua_pushvalue(state, 2);
+    lua_rawget(state, -2);
+    return 1;
+}
+
+// Only elements can be set, so names aren't converted to indices.
+template <class Container>
+int sequence_view_newindex(lua_State* const state)
+{
+    typedef typename Container::value_type value_type;
+    auto& view = lua::get<lua::sequence_view<Container>&>(state, 1);
+
+    if (lua_type(state, 2) != LUA_TNUMBER || static_cast<lua_Number>(lua_tointeger(state, 2)) != lua_tonumber(state, 2)) {
+        std::stringstream str;
+        str << "lua::sequence_view: Only integer indices can be set, but a "
+            << lua_typename(state, lua_type(state, 2)) << " was given";
+        throw lua::error(str.str());
+    }
+    view.set(lua_tointeger(state, 2), lua::get<value_type>(state, 3));
+    return 0;
+}
+
+template <class Container>
+int sequence_view_next(lua_State* const state)
+{
+    typedef typename Container::value_type value_type;
+    auto& view = lua::get<lua::sequence_view<Container>&>(state, 1);
+
+    auto index = lua_tointeger(state, 2) + 1;
+    if (index < 1 || static_cast<size_t>(index) > view.size()) {
+        return 0;
+    }
+    lua_pushinteger(state, index);
+    lua::SequenceElement<value_type>::push(state, view.container()[index - 1]);
+    return 2;
+}
+
+template <class Container>
+int sequence_view_ipairs(lua_State* const state)
+{
+    lua_pushcfunction(state, sequence_view_next<Container>);
+    lua_pushvalue(state, 1);
+    lua_pushinteger(state, 0);
+    return 3;
+}
+
+template <class Container>
+int sequence_view_table(lua_State* const state)
+{
+    auto& view = lua::get<lua::sequence_view<Container>&>(state, 1);
+    auto& container = view.container();
+    lua::push_sequence(state, container.begin(), container.end(), container.size());
+    return 1;
+}
+
+// The class name of views of the container; see LUACXX_SEQUENCE_VIEW_NAME.
+template <class Container>
+struct sequence_view_type
+{
+    static constexpr const char* name = "";
+};
+
+template <class Container>
+struct Metatable<lua::sequence_view<Container>>
+{
+    static constexpr const char* name = lua::sequence_view_type<Container>::name;
+
+    static bool metatable(const lua::index& mt, lua::sequence_view<Container>* const)
+    {
+        typedef lua::sequence_view<Container> view;
+
+        mt["__index"] = lua::sequence_view_index<Container>;
+        mt["__newindex"] = lua::sequence_view_newindex<Container>;
+        mt["__len"] = &view::size;
+        mt["__ipairs"] = lua::sequence_view_ipairs<Container>;
+
+        mt["size"] = &view::size;
+        mt["append"] = &view::append;
+        mt["insert"] = &view::insert;
+        mt["remove"] = &view::remove;
+        mt["clear"] = &view::clear;
+        mt["table"] = lua::sequence_view_table<Container>;
+        return true;
+    }
+};
+
+} // namespace lua
+
+#define LUACXX_SEQUENCE_VIEW_NAME(...) \
+    namespace lua { \
+    template <> \
+    struct sequence_view_type<__VA_ARGS__> \
+    { \
+        static constexpr const char* name = "lua::sequence_view<" #__VA_ARGS__ ">"; \
+    }; \
+    }
+
+#define LUACXX_SEQUENCE_VIEW_NAMES(container) \
+    LUACXX_SEQUENCE_VIEW_NAME(container<float>) \
+    LUACXX_SEQUENCE_VIEW_NAME(container<double>) \
+    LUACXX_SEQUENCE_VIEW_NAME(container<int>) \
+    LUACXX_SEQUENCE_VIEW_NAME(container<unsigned int>) \
+    LUACXX_SEQUENCE_VIEW_NAME(container<long>) \
+    LUACXX_SEQUENCE_VIEW_NAME(container<unsigned long>) \
+    LUACXX_SEQUENCE_VIEW_NAME(container<long long>) \
+    LUACXX_SEQUENCE_VIEW_NAME(container<unsigned long long>) \
+    LUACXX_SEQUENCE_VIEW_NAME(container<std::string>)
+
+LUACXX_SEQUENCE_VIEW_NAMES(std::vector)
+LUACXX_SEQUENCE_VIEW_NAMES(std::deque)
+
+#endif // LUACXX_SEQUENCE_VIEW_INCLUDED
@@ -17,21 +17,22 @@ char* lua::malloc(lua_State* const state, size_t size, const lua::userdata_block
 {
     // Get and push a chunk of memory from Lua to hold our metadata, as well as
     // the underlying value.
-    char* block = static_cast<char*>(lua_newuserdata(state,
-        size + sizeof(lua::userdata_block)
-    ));
+    void* block = lua_newuserdata(state,
+        lua::userdata_block_size + size
+    );
 
-    // Create the metadata at the end of the memory block; lua_touserdata will return a
-    // valid pointer.
-    new (block + size) lua::userdata_block(userdata_block);
+    // Create the metadata at the start of the memory block, so it is always
+    // found at the pointer returned by lua_touserdata.
+    auto header = new (block) lua::userdata_block(userdata_block);
 
     // Return a pointer to the data block
-    return block;
+    return header->data();
 }
 
 int lua::__gc(lua_State* const state)
 {
     auto userdata_block = lua::get<lua::userdata_block*>(state, 1);
+    auto type = userdata_block->type();
 
     lua_getmetatable(state, 1);
     auto mt = lua::index(state, -1);
@@ -52,5 +53,10 @@ int lua::__gc(lua_State* const state)
         std::cerr << "Error occurred during Lua garbage collection: " << ex.what();
     }
 
+    // The userdata is gone, even if destroying its value failed
+    if (type) {
+        type->destroyed(lua_rawlen(state, 1));
+    }
+
     return 0;
 }
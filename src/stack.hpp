@@ -5,12 +5,17 @@
 #include "error.hpp"
 #include "config.hpp"
 
+#include <atomic>
 #include <memory>
 #include <type_traits>
 #include <new>
 #include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <stdexcept>
+#include <utility>
 #include <sstream>
 
 /*
@@ -410,7 +415,7 @@ public:
     }
 
     template <class T>
-    const link& operator=(T value) const;
+    const link& operator=(T&& value) const;
 
     template <class T>
     void operator>>(T& destination);
@@ -779,22 +784,102 @@ enum class userdata_storage {
     shared_ptr
 };
 
-// Metadata that defines the Lua userdata
+// Identifies the C++ type of a userdata. Each type has exactly one of these,
+// so types are compared by address.
+//
+// Each also counts its live userdata, across every state, for lua::census.
+// Types are added to the census when their first userdata is created.
+struct userdata_type
+{
+    const char* name;
+
+    mutable std::atomic<size_t> live;
+    mutable std::atomic<size_t> bytes;
+    mutable std::atomic<bool> listed;
+    mutable const userdata_type* next;
+
+    void created(const size_t size) const
+    {
+        if (!listed.load(std::memory_order_acquire)) {
+            add_to_census();
+        }
+        live.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    void destroyed(const size_t size) const
+    {
+        live.fetch_sub(1, std::memory_order_relaxed);
+        bytes.fetch_sub(size, std::memory_order_relaxed);
+    }
+
+private:
+    void add_to_census() const;
+};
+
+// Metadata that defines the Lua userdata. It is placed at the start of every
+// userdata created by lua::malloc, so it's found without asking Lua for the
+// userdata's size.
 class userdata_block {
+    static const std::uint32_t expected_magic = 0x6c756163;
+
+    const lua::userdata_type* _type;
+    std::uint32_t _magic;
     char _storage;
 
 public:
-    userdata_block(const lua::userdata_storage& storage) :
+    userdata_block(const lua::userdata_storage& storage, const lua::userdata_type* const type = nullptr) :
+        _type(type),
+        _magic(expected_magic),
         _storage(static_cast<char>(storage))
     {
     }
 
-    lua::userdata_storage storage()
+    lua::userdata_storage storage() const
     {
         return static_cast<lua::userdata_storage>(_storage);
     }
+
+    const lua::userdata_type* type() const
+    {
+        return _type;
+    }
+
+    // Returns whether this block was created by lua::malloc, rather than
+    // being some other library's userdata.
+    bool valid() const
+    {
+        return _magic == expected_magic;
+    }
+
+    char* data();
 };
 
+// The size reserved for the userdata_block, keeping the value that follows it
+// aligned.
+const size_t userdata_block_size =
+    (sizeof(lua::userdata_block) + alignof(std::max_align_t) - 1)
+    / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+inline char* userdata_block::data()
+{
+    return reinterpret_cast<char*>(this) + lua::userdata_block_size;
+}
+
+// Returns the userdata_block of the userdata at the given position, or
+// nullptr if that value wasn't created by lua::malloc.
+inline lua::userdata_block* find_userdata_block(lua_State* const state, const int pos)
+{
+    if (lua_type(state, pos) != LUA_TUSERDATA || lua_rawlen(state, pos) < lua::userdata_block_size) {
+        return nullptr;
+    }
+    auto block = static_cast<lua::userdata_block*>(lua_touserdata(state, pos));
+    if (!block->valid()) {
+        return nullptr;
+    }
+    return block;
+}
+
 /*
 
 =head3 METATABLES
@@ -1020,7 +1105,22 @@ for their type:
     } // namespace lua
 
 If the Metatable<> specialization returns true, that metatable will be cached
-and used for all subsequent objects with that metatable's name.
+and used for all subsequent objects of that type. Return false only if the
+metatable depends on the value itself, as every push of that type will then
+build a new metatable.
+
+Cached metatables are kept in the registry, keyed by the address of
+lua::metatable_key<T, Stored>::value rather than by name. This makes finding
+the metatable a pointer lookup, so pushing a userdata never needs to hash its
+class name. It also means types without a name are cached too. If the type
+has a name, the cached metatable is also saved under it for the convenience of
+Lua code.
+
+Collected userdata are destroyed by a __gc function specific to their stored
+type, which calls the destructor directly. If the metatable has a destroy
+method once Metatable<>::metatable returns, __gc calls that method first,
+through lua::call, and then destroys the value. A destroy method added after
+the metatable is created is not called.
 
 */
 
@@ -1032,8 +1132,7 @@ struct Metatable
 
     // Initialize the provided metatable for this type.
     //
-    // Return true if the metatable can be cached for future values (requires
-    // the name to be specified).
+    // Return true if the metatable can be cached for future values.
     static bool metatable(const lua::index& mt, const T* value)
     {
         return true;
@@ -1052,6 +1151,17 @@ struct Metatable<void>
 };
 
 
+// Provides the userdata_type for each C++ type, saved in the userdata_block of
+// every value of that type.
+template <class T>
+struct userdata_type_of
+{
+    static const lua::userdata_type value;
+};
+
+template <class T>
+const lua::userdata_type userdata_type_of<T>::value = { Metatable<T>::name };
+
 template <class T>
 inline void call_destructor(T& value)
 {
@@ -1062,8 +1172,8 @@ inline void call_destructor(T& value)
 template <class Stored>
 int free_userdata(lua_State* const state)
 {
-    char* block = static_cast<char*>(lua_touserdata(state, 1));
-    auto userdata_block = reinterpret_cast<lua::userdata_block*>(block + sizeof(Stored));
+    auto userdata_block = static_cast<lua::userdata_block*>(lua_touserdata(state, 1));
+    char* block = userdata_block->data();
 
     switch (userdata_block->storage()) {
     case userdata_storage::pointer:
@@ -1091,22 +1201,45 @@ int free_userdata(lua_State* const state)
     return 0;
 }
 
+// Collects a userdata whose metatable has a destroy method, calling it
+// before the value's destructor.
 int __gc(lua_State* const state);
 
+// Collects a userdata directly, which is all most types need.
+template <class Stored>
+int collect_userdata(lua_State* const state)
+{
+    auto userdata_block = static_cast<lua::userdata_block*>(lua_touserdata(state, 1));
+    auto type = userdata_block->type();
+
+    free_userdata<Stored>(state);
+    userdata_block->~userdata_block();
+
+    if (type) {
+        type->destroyed(lua_rawlen(state, 1));
+    }
+    return 0;
+}
+
+// Provides a unique address for each type, used as the registry key for that
+// type's cached metatable. The stored type is included since each metatable
+// frees its userdata using free_userdata<Stored>.
+template <class T, class Stored>
+struct metatable_key
+{
+    static char value;
+};
+
+template <class T, class Stored>
+char metatable_key<T, Stored>::value = 0;
+
 template <class T, class Stored = T>
 void push_metatable(lua_State* const state, T* const value)
 {
     // Check for a cached metatable first.
-    auto class_name = Metatable<T>::name;
-    if (class_name && std::char_traits<char>::length(class_name) > 0) {
-        // Push whatever we find.
-        lua_getfield(state, LUA_REGISTRYINDEX, class_name);
-    } else {
-        // It doesn't even have a name, so just use nil to fall through gracefully.
-        lua_pushnil(state);
-    }
-    lua::index mt(state, -1);
-    if (mt.type() != lua::type::nil) {
+    auto key = &lua::metatable_key<T, Stored>::value;
+    lua_rawgetp(state, LUA_REGISTRYINDEX, key);
+    if (!lua_isnil(state, -1)) {
         // Use the cached value
         return;
     }
@@ -1114,9 +1247,12 @@ void push_metatable(lua_State* const state, T* const value)
     // Otherwise, clean up and create a new metatable.
     lua_pop(state, 1);
     lua_newtable(state);
+    lua::index mt(state, -1);
+
+    auto class_name = Metatable<T>::name;
 
     // Setup how we destroy the object.
-    lua_pushcclosure(state, __gc, 0);
+    lua_pushcfunction(state, collect_userdata<Stored>);
     lua_setfield(state, mt.pos(), "__gc");
 
     // Make the class name visible to callers
@@ -1139,9 +1275,28 @@ void push_metatable(lua_State* const state, T* const value)
     // Let the programmer set up their type-specific metatable.
     auto cacheable = Metatable<T>::metatable(mt, value);
 
-    // Check if it's cacheable (and actually has a name):
-    if (cacheable && std::char_traits<char>::length(class_name) > 0) {
-        // Cache it for the future
+    // Use the slower __gc if there's a destroy method for it to call, unless
+    // the metatable provided its own.
+    lua_pushstring(state, "destroy");
+    lua_rawget(state, mt.pos());
+    lua_pushstring(state, "__gc");
+    lua_rawget(state, mt.pos());
+    if (!lua_isnil(state, -2) && lua_tocfunction(state, -1) == collect_userdata<Stored>) {
+        lua_pushcfunction(state, __gc);
+        lua_setfield(state, mt.pos(), "__gc");
+    }
+    lua_pop(state, 2);
+
+    if (!cacheable) {
+        return;
+    }
+
+    // Cache it for the future
+    lua_pushvalue(state, mt.pos());
+    lua_rawsetp(state, LUA_REGISTRYINDEX, key);
+
+    // Make it visible to Lua if it actually has a name
+    if (class_name && std::char_traits<char>::length(class_name) > 0) {
         lua_pushvalue(state, mt.pos());
         lua_setfield(state, LUA_REGISTRYINDEX, class_name);
     }
@@ -1151,20 +1306,21 @@ void push_metatable(lua_State* const state, T* const value)
 
 =head2 char* lua::malloc(state, size_t size, (optional) lua::userdata_block)
 
-Creates a new userdata of the given size. The userdata has a userdata_block
-appended to the end of it, so lua_rawlen will not return the same size as
-size was given.
+Creates a new userdata of the given size. The userdata starts with a
+userdata_block, so the returned pointer is not the same as lua_touserdata's,
+and lua_rawlen will not return the same size as size was given. Use
+lua::find_userdata_block to get the block of a userdata on the stack.
 
 */
 
 char* malloc(lua_State* const state, size_t size, const lua::userdata_block& userdata_block = lua::userdata_block(lua::userdata_storage::value));
 
 template <class Stored>
-char* construct_userdata(lua_State* const state, lua::userdata_storage storage)
+char* construct_userdata(lua_State* const state, lua::userdata_storage storage, const lua::userdata_type* const type = nullptr)
 {
     return lua::malloc(state,
         sizeof(Stored),
-        lua::userdata_block(storage)
+        lua::userdata_block(storage, type)
     );
 }
 
@@ -1175,14 +1331,15 @@ struct Construct
     static void construct(lua_State* const state, Rest&&... args)
     {
         // Create a Lua userdata block
-        auto block = construct_userdata<Value>(state, storage);
+        auto block = construct_userdata<Value>(state, storage, &lua::userdata_type_of<Value>::value);
 
-        // Create a value in-place
-        auto value = new (block) Value(args...);
+        // Create a value in-place, moving from the arguments where possible
+        auto value = new (block) Value(std::forward<Rest>(args)...);
 
         // Get the metatable for this type and set it for our userdata.
         lua::push_metatable<Value, Value>(state, value);
         lua_setmetatable(state, -2);
+        lua::userdata_type_of<Value>::value.created(lua::userdata_block_size + sizeof(Value));
     }
 };
 
@@ -1190,17 +1347,18 @@ template <class Value>
 struct Construct<Value, lua::userdata_storage::pointer>
 {
     template <class... Rest>
-    static void construct(lua_State* const state, Rest... args)
+    static void construct(lua_State* const state, Rest&&... args)
     {
         // Create a Lua userdata block
-        auto block = construct_userdata<Value*>(state, lua::userdata_storage::pointer);
+        auto block = construct_userdata<Value*>(state, lua::userdata_storage::pointer, &lua::userdata_type_of<Value>::value);
 
         // Create a value in-place
-        auto value = new (block) Value*(args...);
+        auto value = new (block) Value*(std::forward<Rest>(args)...);
 
         // Get the metatable for this type and set it for our userdata.
         lua::push_metatable<Value, Value*>(state, *value);
         lua_setmetatable(state, -2);
+        lua::userdata_type_of<Value>::value.created(lua::userdata_block_size + sizeof(Value*));
     }
 };
 
@@ -1208,28 +1366,35 @@ template <class Value>
 struct Construct<Value, lua::userdata_storage::shared_ptr>
 {
     template <class... Rest>
-    static void construct(lua_State* const state, Rest... args)
+    static void construct(lua_State* const state, Rest&&... args)
     {
         // Create a Lua userdata block
-        auto block = construct_userdata<std::shared_ptr<Value>>(state, lua::userdata_storage::shared_ptr);
+        auto block = construct_userdata<std::shared_ptr<Value>>(state, lua::userdata_storage::shared_ptr, &lua::userdata_type_of<Value>::value);
 
         // Create a value in-place
-        auto value = new (block) std::shared_ptr<Value>(args...);
+        auto value = new (block) std::shared_ptr<Value>(std::forward<Rest>(args)...);
 
         // Get the metatable for this type and set it for our userdata.
         lua::push_metatable<Value, std::shared_ptr<Value>>(state, value->get());
         lua_setmetatable(state, -2);
+        lua::userdata_type_of<Value>::value.created(lua::userdata_block_size + sizeof(std::shared_ptr<Value>));
     }
 };
 
 template <class T>
 struct Push
 {
-    static void push(lua_State* const state, T value)
+    static void push(lua_State* const state, const T& value)
     {
         // By default, "push" means "construct a userdata by value"
         Construct<T>::construct(state, value);
     }
+
+    static void push(lua_State* const state, T&& value)
+    {
+        // Temporaries are moved into the userdata
+        Construct<T>::construct(state, std::move(value));
+    }
 };
 
 template <class T>
@@ -1264,7 +1429,7 @@ struct Push<std::shared_ptr<T>>
 
 /*
 
-=head2 lua::index push(state, T value, Rest... values)
+=head2 lua::index push(state, T&& value, Rest&&... values)
 
     #include <luacxx/convert/string.hpp>
     #include <luacxx/convert/numeric.hpp>
@@ -1277,7 +1442,12 @@ struct Push<std::shared_ptr<T>>
 Pushes the specified values onto the stack, and returns an index referring to
 the topmost value. Internally, lua::push just calls the Push struct, like so:
 
-    lua::Push<T>::push(state, value);
+    lua::Push<typename std::decay<T>::type>::push(state, std::forward<T>(value));
+
+Values are forwarded all the way into the Push struct, so temporaries are
+moved rather than copied into any userdata that is created. A Push struct may
+take its value by value, by const reference, or provide an rvalue overload of
+its own.
 
 Specialize the lua::Push struct if you wish for your type to be handled
 specially. For instance, the struct for lua::index looks like this:
@@ -1295,10 +1465,10 @@ specially. For instance, the struct for lua::index looks like this:
 */
 
 template <class T>
-lua::index push(lua_State* const state, T value)
+lua::index push(lua_State* const state, T&& value)
 {
     // Forward to the struct
-    lua::Push<T>::push(state, value);
+    lua::Push<typename std::decay<T>::type>::push(state, std::forward<T>(value));
     return lua::index(state, -1);
 }
 
@@ -1306,11 +1476,11 @@ lua::index push(lua_State* const state, T value)
 lua::index push(lua_State* const state);
 
 template <class T, class... Rest>
-lua::index push(lua_State* const state, T value, Rest... values)
+lua::index push(lua_State* const state, T&& value, Rest&&... values)
 {
     // Forward everything to the struct
-    lua::Push<T>::push(state, value);
-    return push(state, values...);
+    lua::Push<typename std::decay<T>::type>::push(state, std::forward<T>(value));
+    return push(state, std::forward<Rest>(values)...);
 }
 
 /*
@@ -1325,7 +1495,7 @@ is defined as:
 */
 
 template <class Value>
-lua::index push(Value value)
+lua::index push(const Value& value)
 {
     // Assume the value is some sort of Lua object.
     return lua::push(value.state(), value);
@@ -1333,11 +1503,11 @@ lua::index push(Value value)
 
 template <class Source, class Name>
 template <class T>
-const lua::link<Source, Name>& lua::link<Source, Name>::operator=(T value) const
+const lua::link<Source, Name>& lua::link<Source, Name>::operator=(T&& value) const
 {
     lua::push(state(), _source);
     lua::push(state(), _name);
-    lua::push(state(), value);
+    lua::push(state(), std::forward<T>(value));
     lua_settable(state(), -3);
     lua_pop(state(), 1);
 
@@ -1460,31 +1630,104 @@ static void store_userdata(T& destination, const lua::index& source)
         );
     } else {
         // Get a userdata value and set up the parameters for the inner procedure.
-        auto block = static_cast<char*>(lua_touserdata(source.state(), source.pos()));
-        if (!block) {
+        auto userdata_block = lua::find_userdata_block(source.state(), source.pos());
+        if (!userdata_block) {
             std::stringstream str;
             str << "lua::store_userdata: Source at stack position " << source.pos()
                 << " was a " << source.type().name() << ", not a userdata as required.";
             throw lua::error(str.str());
         }
 
-        char* userdata_block = block + lua_rawlen(source.state(), source.pos()) - sizeof(lua::userdata_block);
         store_full_userdata<storage>(
             destination,
-            reinterpret_cast<lua::userdata_block*>(userdata_block),
-            block
+            userdata_block,
+            userdata_block->data()
         );
     }
 }
 
+// Converts a number to T. Converting a floating-point value that an integral T
+// can't hold is undefined, so those are clamped to T's range, and NaN is zero.
+template <class T, class Source, class Enable = void>
+struct clamped_number
+{
+    static T cast(const Source value)
+    {
+        return static_cast<T>(value);
+    }
+};
+
+template <class T, class Source>
+struct clamped_number<T, Source, typename std::enable_if<
+    std::is_integral<T>::value && std::is_floating_point<Source>::value
+>::type>
+{
+    static T cast(const Source value)
+    {
+        if (value != value) {
+            return T();
+        }
+        if (!(value > static_cast<Source>(std::numeric_limits<T>::min()))) {
+            return std::numeric_limits<T>::min();
+        }
+        if (value >= static_cast<Source>(std::numeric_limits<T>::max())) {
+            return std::numeric_limits<T>::max();
+        }
+        return static_cast<T>(value);
+    }
+};
+
+template <class T, class Source>
+T clamp_number(const Source value)
+{
+    return lua::clamped_number<T, Source>::cast(value);
+}
+
+// Enumerations are pushed as userdata, but can also be given as plain numbers.
+template <class T, class Enable = void>
+struct enum_number
+{
+    static bool is(const lua::index& source)
+    {
+        return false;
+    }
+
+    static T get(const lua::index& source)
+    {
+        throw lua::error("lua::enum_number::get: Only enumerations can be read from numbers");
+    }
+};
+
+template <class T>
+struct enum_number<T, typename std::enable_if<std::is_enum<T>::value>::type>
+{
+    static bool is(const lua::index& source)
+    {
+        return lua_type(source.state(), source.pos()) == LUA_TNUMBER;
+    }
+
+    static T get(const lua::index& source)
+    {
+        return static_cast<T>(lua_tointeger(source.state(), source.pos()));
+    }
+};
+
 template <typename T>
 struct Store
 {
+    // Marks T as a userdata type, so lua::Get<T> can copy it directly from
+    // the userdata rather than assigning it to a default-constructed value.
+    typedef T userdata_type;
+
     static void store(T& destination, const lua::index& source)
     {
         if (source.type().nil()) {
             throw lua::error("lua::Store<T>::store: source stack value must not be nil");
         }
+        if (lua::enum_number<T>::is(source)) {
+            destination = lua::enum_number<T>::get(source);
+            return;
+        }
         // Retrieve the userdata as a value
         store_userdata<lua::userdata_storage::value>(destination, source);
     }
@@ -1532,7 +1775,7 @@ Store the value at the given index into the object specified by destination.
     assert(foo == 42);
 
 Internally, this refers to the lua::Store<T> struct, so behavior can be
-specialized for new types. For instance, this is the definition for
+specialized for new types. For instance, this is a simplified definition of
 lua::Store<std::string>:
 
     template <>
@@ -1540,7 +1783,9 @@ lua::Store<std::string>:
     {
         static void store(std::string& destination, const lua::index& source)
         {
-            destination = lua::get<const char*>(source);
+            size_t len = 0;
+            auto data = lua_tolstring(source.state(), source.pos(), &len);
+            destination.assign(data, len);
         }
     };
 
@@ -1595,6 +1840,24 @@ lua::index operator>>(const lua::index& source, T& destination)
 }
 
 template <typename T>
+struct is_userdata_store
+{
+    template <typename Store>
+    static std::true_type test(typename Store::userdata_type*);
+
+    template <typename Store>
+    static std::false_type test(...);
+
+    static constexpr bool value = decltype(test<lua::Store<T>>(nullptr))::value;
+};
+
+template <>
+struct is_userdata_store<void>
+{
+    static constexpr bool value = false;
+};
+
+template <typename T, typename Enable = void>
 struct Get
 {
     static T get(const lua::index& source)
@@ -1605,6 +1868,33 @@ struct Get
     }
 };
 
+template <typename T>
+struct Get<T, typename std::enable_if<lua::is_userdata_store<T>::value>::type>
+{
+    static T get(const lua::index& source)
+    {
+        if (source.type().nil()) {
+            throw lua::error("lua::Get<T>::get: source stack value must not be nil");
+        }
+        if (lua::enum_number<T>::is(source)) {
+            return lua::enum_number<T>::get(source);
+        }
+
+        // Copy-construct the value straight from the userdata
+        T* value = nullptr;
+        store_userdata<lua::userdata_storage::pointer>(value, source);
+        return *value;
+    }
+};
+
+template <>
+struct Get<void>
+{
+    static void get(const lua::index& source)
+    {
+    }
+};
+
 template <typename T>
 struct Get<const T&>
 {
@@ -1654,9 +1944,9 @@ template <>
 void get<void>(const lua::index& source);
 
 template <class T>
-T get(lua_State* const state, const int pos)
+auto get(lua_State* const state, const int pos) -> decltype(lua::Get<T>::get(lua::index(state, pos)))
 {
-    return lua::get<T>(lua::index(state, pos));
+    return lua::Get<T>::get(lua::index(state, pos));
 }
 
 template <class Source, class Name>
@@ -1686,7 +1976,7 @@ specified arguments.
 template <class T, class... Args>
 T* make(lua_State* const state, Args&&... args)
 {
-    Construct<T>::construct(state, args...);
+    Construct<T>::construct(state, std::forward<Args>(args)...);
     return lua::get<T*>(state, -1);
 }
 
@@ -0,0 +1,198 @@
+#include "state_pool.hpp"
+
+#include "error.hpp"
+#include "load.hpp"
+
+namespace {
+
+// Registry keys for each state's baseline
+char baseline_globals_key;
+char baseline_loaded_key;
+char baseline_metatable_key;
+
+// Pushes a copy of the table at the given position, without its metatable.
+void push_copy(lua_State* const state, const int source)
+{
+    lua_newtable(state);
+    lua_pushnil(state);
+    while (lua_next(state, source)) {
+        lua_pushvalue(state, -2);
+        lua_insert(state, -2);
+        lua_rawset(state, -4);
+    }
+}
+
+// Makes the table at the given position have the same fields as the baseline
+// table at the given position.
+void restore_fields(lua_State* const state, const int table, const int baseline)
+{
+    // Clearing existing fields is allowed while traversing a table
+    lua_pushnil(state);
+    while (lua_next(state, table)) {
+        lua_pop(state, 1);
+        lua_pushvalue(state, -1);
+        lua_rawget(state, baseline);
+        if (lua_isnil(state, -1)) {
+            lua_pushvalue(state, -2);
+            lua_pushnil(state);
+            lua_rawset(state, table);
+        }
+        lua_pop(state, 1);
+    }
+
+    lua_pushnil(state);
+    while (lua_next(state, baseline)) {
+        lua_pushvalue(state, -2);
+        lua_insert(state, -2);
+        lua_rawset(state, table);
+    }
+}
+
+int record_baseline(lua_State* const state)
+{
+    lua::push(state, lua::value::globals);
+    auto globals = lua_gettop(state);
+    lua_getfield(state, LUA_REGISTRYINDEX, "_LOADED");
+    auto loaded = lua_gettop(state);
+
+    lua_pushlightuserdata(state, &baseline_globals_key);
+    push_copy(state, globals);
+    lua_rawset(state, LUA_REGISTRYINDEX);
+
+    lua_pushlightuserdata(state, &baseline_loaded_key);
+    push_copy(state, loaded);
+    lua_rawset(state, LUA_REGISTRYINDEX);
+
+    lua_pushlightuserdata(state, &baseline_metatable_key);
+    if (!lua_getmetatable(state, globals)) {
+        lua_pushnil(state);
+    }
+    lua_rawset(state, LUA_REGISTRYINDEX);
+
+    return 0;
+}
+
+int restore_baseline(lua_State* const state)
+{
+    lua::push(state, lua::value::globals);
+    auto globals = lua_gettop(state);
+    lua_getfield(state, LUA_REGISTRYINDEX, "_LOADED");
+    auto loaded = lua_gettop(state);
+
+    lua_pushlightuserdata(state, &baseline_globals_key);
+    lua_rawget(state, LUA_REGISTRYINDEX);
+    restore_fields(state, globals, lua_gettop(state));
+
+    lua_pushlightuserdata(state, &baseline_loaded_key);
+    lua_rawget(state, LUA_REGISTRYINDEX);
+    restore_fields(state, loaded, lua_gettop(state));
+
+    lua_pushlightuserdata(state, &baseline_metatable_key);
+    lua_rawget(state, LUA_REGISTRYINDEX);
+    lua_setmetatable(state, globals);
+
+    return 0;
+}
+
+// Runs the given function in protected mode, so running out of memory is
+// reported rather than fatal.
+bool run_protected(lua_State* const state, lua_CFunction func)
+{
+    lua_settop(state, 0);
+    lua_pushcfunction(state, func);
+    auto result = lua_pcall(state, 0, 0, 0);
+    lua_settop(state, 0);
+    return result == LUA_OK;
+}
+
+} // namespace anonymous
+
+lua::state_pool::state_pool(const size_t size, initializer init) :
+    _initializer(init),
+    _size(0)
+{
+    _available.reserve(size);
+    try {
+        for (size_t i = 0; i < size; ++i) {
+            _available.push_back(create_state());
+            ++_size;
+        }
+    } catch (...) {
+        for (auto state : _available) {
+            lua::close(state);
+        }
+        throw;
+    }
+}
+
+lua::state_pool::~state_pool()
+{
+    for (auto state : _available) {
+        lua::close(state);
+    }
+}
+
+lua_State* lua::state_pool::create_state()
+{
+    // env closes the state if initialization fails
+    auto env = lua::create();
+    if (_initializer) {
+        _initializer(env.state());
+    }
+    if (!run_protected(env.state(), record_baseline)) {
+        throw lua::error("lua::state_pool: Failed to record a state's baseline");
+    }
+    env.clear_owner();
+    return env.state();
+}
+
+lua::state_pool::lease lua::state_pool::acquire()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_available.empty()) {
+            auto state = _available.back();
+            _available.pop_back();
+            return lease(this, state);
+        }
+    }
+
+    // Initialize the new state without holding the lock
+    auto state = create_state();
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_size;
+    return lease(this, state);
+}
+
+void lua::state_pool::release(lua_State* const state)
+{
+    if (!run_protected(state, restore_baseline)) {
+        lua::close(state);
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_size;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _available.push_back(state);
+}
+
+size_t lua::state_pool::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _size;
+}
+
+size_t lua::state_pool::available() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _available.size();
+}
+
+lua::state_pool::initializer lua::chunk_initializer(const std::string& chunk, const std::string& name)
+{
+    return [chunk, name](lua_State* const state) {
+        lua::invoke(lua::load_chunk(state, chunk, name));
+        lua_settop(state, 0);
+    };
+}
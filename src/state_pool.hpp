@@ -0,0 +1,182 @@
+#ifndef LUACXX_STATE_POOL_INCLUDED
+#define LUACXX_STATE_POOL_INCLUDED
+
+#include "stack.hpp"
+#include "thread.hpp"
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+
+=head1 NAME
+
+lua::state_pool - initialized Lua states, ready to be leased
+
+=head1 SYNOPSIS
+
+    #include <luacxx/state_pool.hpp>
+
+    // Create four states, each with its modules already loaded
+    lua::state_pool pool(4, [](lua_State* const state) {
+        lua::thread env(state);
+        lua::run_string(env, "require 'luacxx.Qt5Core'");
+    });
+
+    void handle_request(const std::string& script)
+    {
+        auto lease = pool.acquire();
+        lua::run_string(lease.env(), script);
+
+        // The state is reset and returned when the lease is destroyed
+    }
+
+=head1 DESCRIPTION
+
+Creating a state, opening its libraries, and loading modules can take far
+longer than the work the state is needed for. A state_pool does that work up
+front, for a number of states, and then lends them out.
+
+Once the pool has initialized a state, it records the state's baseline: the
+fields of its global table, and the modules in package.loaded. When a lease is
+returned, the state is reset to that baseline: the stack is cleared, new
+globals and modules are removed, and replaced or removed ones are restored,
+along with the global table's metatable. This takes about as long as walking
+those tables, so leases are cheap.
+
+The reset is shallow. Changes made within the baseline's tables, such as
+adding a function to the string table, or changing a field of a loaded module,
+are kept. Registry entries, like lua::references that were never released,
+are kept too. Scripts that must not see each other's changes shouldn't make
+them there.
+
+The pool may be used from several threads at once, though each leased state
+must only be used by one thread at a time, as usual.
+
+=head4 lua::state_pool(size, initializer)
+
+Creates size states using lua::create(), and gives each to the initializer, if
+there is one, before recording its baseline.
+
+=head4 lease pool.acquire()
+
+Leases an available state. If every state is leased, a new one is created and
+initialized, and it joins the pool when its lease is returned.
+
+Leases can be moved but not copied. A state is returned when its lease is
+destroyed, or by calling release(). If the state can't be reset, such as when
+it's run out of memory, it's closed rather than returned.
+
+Every lease must be returned before its pool is destroyed.
+
+=head4 size_t pool.size(), size_t pool.available()
+
+Returns the number of states that belong to the pool, and of those, the number
+that aren't leased.
+
+=head4 lua::state_pool::initializer lua::chunk_initializer(chunk, name)
+
+Returns an initializer that loads the given chunk, using lua::load_chunk, and
+runs it. Code can be compiled once, and then shared by every state as its
+bytecode:
+
+    auto env = lua::create();
+    std::string script("function transform(x) return x * 2 end");
+    auto bytecode = lua::dump_bytecode(lua::load_string(env, script));
+
+    lua::state_pool pool(4, lua::chunk_initializer(bytecode));
+
+*/
+
+namespace lua {
+
+class state_pool
+{
+public:
+    typedef std::function<void(lua_State* const)> initializer;
+
+    class lease
+    {
+        state_pool* _pool;
+        lua::thread _env;
+
+    public:
+        lease(state_pool* const pool, lua_State* const state) :
+            _pool(pool),
+            _env(state)
+        {
+        }
+
+        lease(lease&& other) :
+            _pool(other._pool),
+            _env(other._env.state())
+        {
+            other._pool = nullptr;
+        }
+
+        lease(const lease&) = delete;
+        lease& operator=(const lease&) = delete;
+
+        ~lease()
+        {
+            release();
+        }
+
+        lua::thread& env()
+        {
+            return _env;
+        }
+
+        lua_State* const state() const
+        {
+            return _env.state();
+        }
+
+        operator lua_State*() const
+        {
+            return _env.state();
+        }
+
+        explicit operator bool() const
+        {
+            return _pool != nullptr;
+        }
+
+        void release()
+        {
+            if (_pool) {
+                _pool->release(_env.state());
+                _pool = nullptr;
+            }
+        }
+    };
+
+    state_pool(const size_t size, initializer init = initializer());
+    ~state_pool();
+
+    state_pool(const state_pool&) = delete;
+    state_pool& operator=(const state_pool&) = delete;
+
+    lease acquire();
+
+    size_t size() const;
+    size_t available() const;
+
+private:
+    initializer _initializer;
+
+    mutable std::mutex _mutex;
+    std::vector<lua_State*> _available;
+    size_t _size;
+
+    lua_State* create_state();
+    void release(lua_State* const state);
+};
+
+state_pool::initializer chunk_initializer(const std::string& chunk, const std::string& name = "chunk");
+
+} // namespace lua
+
+#endif // LUACXX_STATE_POOL_INCLUDED
@@ -0,0 +1,163 @@
+#ifndef LUACXX_TABLE_BUILDER_INCLUDED
+#define LUACXX_TABLE_BUILDER_INCLUDED
+
+#include "stack.hpp"
+
+#include <limits>
+#include <utility>
+
+/*
+
+=head1 NAME
+
+lua::table_builder - fill a new Lua table quickly
+
+=head1 SYNOPSIS
+
+    #include <luacxx/table_builder.hpp>
+
+    int list_files(lua_State* const state)
+    {
+        auto files = read_directory(lua::get<std::string>(state, 1));
+
+        lua::table_builder table(state, files.size(), 0);
+        for (auto& file : files) {
+            table.append(file.name);
+        }
+        return 1;
+    }
+
+    lua::table_builder(state, 0, 2)
+        .set("width", 640)
+        .set("height", 480);
+
+=head1 DESCRIPTION
+
+lua::table::insert and lua::table::set push their table again for each value,
+check its type, and insert computes the table's length each time. That's
+reasonable for a few values, but it dominates the time spent building large
+tables.
+
+A table_builder creates its table with lua_createtable, so it's sized once
+from the given hints, and leaves it on the stack. Values are then added with
+raw operations against that stack position, and appended values are counted
+rather than measured. Metamethods are not called.
+
+Values pushed between calls must be popped before the next call, since the
+table's position is fixed. The table stays on the stack when the builder is
+destroyed.
+
+=head4 lua::table_builder(state, array_size, hash_size)
+
+Pushes a new table, with room for the given number of array and hash entries.
+
+=head4 lua::table_builder(table)
+
+Adds to an existing table at the given stack position. Appended values start
+after the table's current length.
+
+=head4 builder.append(value), builder.set(key, value)
+
+Adds a value to the end of the array part, or sets a field. Both return the
+builder, so calls can be chained. set() throws a lua::error for a key that is
+nil or NaN, leaving the table as it was. If pushing a value throws, the key is
+popped before the exception is passed on.
+
+*/
+
+namespace lua {
+
+class table_builder
+{
+    lua_State* _state;
+    int _pos;
+    int _length;
+
+    // Pops and throws for the pushed key if Lua can't use it, since
+    // lua_rawset would raise an error outside of any protected call.
+    void check_key()
+    {
+        auto type = lua_type(_state, -1);
+        if (type == LUA_TNIL) {
+            lua_pop(_state, 1);
+            throw lua::error("lua::table_builder: Table keys must not be nil");
+        }
+        if (type == LUA_TNUMBER) {
+            auto number = lua_tonumber(_state, -1);
+            if (number != number) {
+                lua_pop(_state, 1);
+                throw lua::error("lua::table_builder: Table keys must not be NaN");
+            }
+        }
+    }
+
+public:
+    table_builder(lua_State* const state, const size_t array_size = 0, const size_t hash_size = 0) :
+        _state(state),
+        _pos(0),
+        _length(0)
+    {
+        const size_t limit = std::numeric_limits<int>::max();
+        if (array_size > limit || hash_size > limit) {
+            throw lua::error("lua::table_builder: Too many values for a Lua table");
+        }
+        lua_createtable(state, static_cast<int>(array_size), static_cast<int>(hash_size));
+        _pos = lua_gettop(state);
+    }
+
+    explicit table_builder(const lua::index& table) :
+        _state(table.state()),
+        _pos(lua_absindex(table.state(), table.pos())),
+        _length(0)
+    {
+        if (!table.type().table()) {
+            throw lua::error("lua::table_builder: Lua stack value must be a table");
+        }
+        _length = lua_rawlen(_state, _pos);
+    }
+
+    lua_State* const state() const
+    {
+        return _state;
+    }
+
+    lua::index table() const
+    {
+        return lua::index(_state, _pos);
+    }
+
+    // Returns the number of values in the array part.
+    int length() const
+    {
+        return _length;
+    }
+
+    template <class Value>
+    table_builder& append(Value&& value)
+    {
+        lua::push(_state, std::forward<Value>(value));
+        lua_rawseti(_state, _pos, ++_length);
+        return *this;
+    }
+
+    template <class Key, class Value>
+    table_builder& set(Key&& key, Value&& value)
+    {
+        auto top = lua_gettop(_state);
+        lua::push(_state, std::forward<Key>(key));
+        check_key();
+        try {
+            lua::push(_state, std::forward<Value>(value));
+        } catch (...) {
+            // Drop the key, and anything the value left behind.
+            lua_settop(_state, top);
+            throw;
+        }
+        lua_rawset(_state, _pos);
+        return *this;
+    }
+};
+
+} // namespace lua
+
+#endif // LUACXX_TABLE_BUILDER_INCLUDED
@@ -0,0 +1,333 @@
+#ifndef LUACXX_TABLE_VIEW_INCLUDED
+#define LUACXX_TABLE_VIEW_INCLUDED
+
+#include "stack.hpp"
+#include "convert/vector.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+/*
+
+=head1 NAME
+
+lua::table_view - iterate over a Lua table from C++, without copying it
+
+=head1 SYNOPSIS
+
+    #include <luacxx/table_view.hpp>
+
+    int sum(lua_State* const state)
+    {
+        lua_Number rv = 0;
+        for (auto value : lua::table_view<lua_Number>(lua::index(state, 1))) {
+            rv += value;
+        }
+        lua::push(state, rv);
+        return 1;
+    }
+
+    int count_flags(lua_State* const state)
+    {
+        int rv = 0;
+        for (auto pair : lua::table_map_view<std::string, bool>(lua::index(state, 1))) {
+            if (pair.second) {
+                ++rv;
+            }
+        }
+        lua::push(state, rv);
+        return 1;
+    }
+
+=head1 DESCRIPTION
+
+Storing a table into a std::vector or similar container converts every element
+up front, and needs memory for all of them. These views instead convert each
+element as it's reached, and keep nothing but their position.
+
+Tables are accessed raw, so metamethods are not called. Like lua::index, a view
+refers to a stack position, so the table must stay there while the view is
+used.
+
+=head4 lua::table_view<T>(table)
+
+Iterates over the sequence from table[1] to table[#table], using lua_rawgeti,
+and converts each value using lua::get<T>. The length is read once, when the
+view is created. Elements can also be read by position, using view[i] with a
+0-based index, like a C++ container.
+
+References to userdata, such as table_view<const QPointF&>, refer to the
+userdata in the table, so nothing is copied.
+
+=head4 lua::table_map_view<K, V>(table)
+
+Iterates over every key and value of the table, using lua_next, and converts
+each pair to a std::pair<K, V>. The order is unspecified, as with pairs().
+
+The current key and value, and a copy of the key, are kept on the stack during
+each step. They're removed when the view reaches its end, or when the iterator
+is destroyed, so leaving the loop early keeps the stack balanced. The loop's
+body may push values, but mustn't pop values it didn't push.
+
+Keys and values must not be added to the table while it's being iterated,
+though existing fields may be changed or cleared.
+
+*/
+
+namespace lua {
+
+template <class T>
+class table_view
+{
+    lua_State* _state;
+    int _pos;
+    size_t _size;
+
+    // Numbers skip lua::get, like the elements of a stored std::vector.
+    T get(std::true_type) const
+    {
+        T rv;
+        lua::SequenceElement<T>::store(rv, _state, -1);
+        return rv;
+    }
+
+    decltype(lua::get<T>(std::declval<const lua::index&>())) get(std::false_type) const
+    {
+        return lua::get<T>(lua::index(_state, -1));
+    }
+
+public:
+    typedef decltype(lua::get<T>(std::declval<const lua::index&>())) value_type;
+
+    class iterator
+    {
+        const table_view* _view;
+        size_t _index;
+
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef typename std::decay<table_view::value_type>::type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef value_type* pointer;
+        typedef table_view::value_type reference;
+
+        iterator(const table_view* const view, const size_t index) :
+            _view(view),
+            _index(index)
+        {
+        }
+
+        reference operator*() const
+        {
+            return (*_view)[_index];
+        }
+
+        iterator& operator++()
+        {
+            ++_index;
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator rv(*this);
+            ++_index;
+            return rv;
+        }
+
+        bool operator==(const iterator& other) const
+        {
+            return _index == other._index;
+        }
+
+        bool operator!=(const iterator& other) const
+        {
+            return _index != other._index;
+        }
+    };
+
+    table_view(const lua::index& table) :
+        _state(table.state()),
+        _pos(lua_absindex(table.state(), table.pos())),
+        _size(0)
+    {
+        if (!table.type().table()) {
+            throw lua::error("lua::table_view: Lua stack value must be a table");
+        }
+        _size = lua_rawlen(_state, _pos);
+    }
+
+    lua_State* const state() const
+    {
+        return _state;
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    value_type operator[](const size_t index) const
+    {
+        lua_rawgeti(_state, _pos, static_cast<int>(index + 1));
+        value_type rv = get(std::is_arithmetic<T>());
+        lua_pop(_state, 1);
+        return rv;
+    }
+
+    iterator begin() const
+    {
+        return iterator(this, 0);
+    }
+
+    iterator end() const
+    {
+        return iterator(this, _size);
+    }
+};
+
+template <class K, class V>
+class table_map_view
+{
+    lua_State* _state;
+    int _pos;
+
+public:
+    typedef decltype(lua::get<K>(std::declval<const lua::index&>())) key_type;
+    typedef decltype(lua::get<V>(std::declval<const lua::index&>())) mapped_type;
+    typedef std::pair<key_type, mapped_type> value_type;
+
+    // Iterators own the key and value on the stack, so they can be moved
+    // but not copied.
+    class iterator
+    {
+        lua_State* _state;
+        int _table;
+
+        // The stack position of the key given to lua_next, or 0 at the end.
+        // A copy of the key follows it, and then the value. Only the copy is
+        // converted, since converting a number to a string changes it in
+        // place, which would confuse lua_next.
+        int _key;
+
+        void next()
+        {
+            if (lua_next(_state, _table) != 0) {
+                lua_pushvalue(_state, -2);
+                lua_insert(_state, -2);
+                _key = lua_gettop(_state) - 2;
+            } else {
+                _key = 0;
+            }
+        }
+
+    public:
+        iterator(lua_State* const state, const int table, const bool begin) :
+            _state(state),
+            _table(table),
+            _key(0)
+        {
+            if (begin) {
+                lua_pushnil(_state);
+                next();
+            }
+        }
+
+        iterator(const iterator&) = delete;
+        iterator& operator=(const iterator&) = delete;
+
+        iterator(iterator&& other) :
+            _state(other._state),
+            _table(other._table),
+            _key(other._key)
+        {
+            other._key = 0;
+        }
+
+        ~iterator()
+        {
+            if (_key) {
+                lua_remove(_state, _key + 2);
+                lua_remove(_state, _key + 1);
+                lua_remove(_state, _key);
+            }
+        }
+
+        value_type operator*() const
+        {
+            return value_type(
+                lua::get<K>(lua::index(_state, _key + 1)),
+                lua::get<V>(lua::index(_state, _key + 2))
+            );
+        }
+
+        // Returns the current key and value, without converting them.
+        lua::index key() const
+        {
+            return lua::index(_state, _key + 1);
+        }
+
+        lua::index value() const
+        {
+            return lua::index(_state, _key + 2);
+        }
+
+        iterator& operator++()
+        {
+            // Drop the value and copied key, and move the key to the top for lua_next
+            lua_remove(_state, _key + 2);
+            lua_remove(_state, _key + 1);
+            if (_key != lua_gettop(_state)) {
+                lua_pushvalue(_state, _key);
+                lua_remove(_state, _key);
+            }
+            next();
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const
+        {
+            return _key == other._key;
+        }
+
+        bool operator!=(const iterator& other) const
+        {
+            return _key != other._key;
+        }
+    };
+
+    table_map_view(const lua::index& table) :
+        _state(table.state()),
+        _pos(lua_absindex(table.state(), table.pos()))
+    {
+        if (!table.type().table()) {
+            throw lua::error("lua::table_map_view: Lua stack value must be a table");
+        }
+    }
+
+    lua_State* const state() const
+    {
+        return _state;
+    }
+
+    iterator begin() const
+    {
+        return iterator(_state, _pos, true);
+    }
+
+    iterator end() const
+    {
+        return iterator(_state, _pos, false);
+    }
+};
+
+} // namespace lua
+
+#endif // LUACXX_TABLE_VIEW_INCLUDED
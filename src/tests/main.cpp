@@ -4,17 +4,35 @@
 #include "thread.hpp"
 #include "stack.hpp"
 #include "algorithm.hpp"
+#include "batch.hpp"
 #include "load.hpp"
 #include "reference.hpp"
+#include "overload.hpp"
+#include "parallel.hpp"
+#include "key.hpp"
+#include "buffer.hpp"
+#include "census.hpp"
+#include "function.hpp"
+#include "sequence_view.hpp"
+#include "state_pool.hpp"
+#include "table_builder.hpp"
+#include "table_view.hpp"
 
 #include "convert/string.hpp"
 #include "convert/char.hpp"
 #include "convert/callable.hpp"
 #include "convert/numeric.hpp"
+#include "convert/vector.hpp"
+#include "convert/array.hpp"
+#include "convert/deque.hpp"
+#include "convert/map.hpp"
+#include "convert/unordered_map.hpp"
 
 #include <boost/test/unit_test.hpp>
 
 #include <memory>
+#include <cstring>
+#include <limits>
 
 BOOST_AUTO_TEST_CASE(push_and_store)
 {
@@ -255,6 +273,42 @@ BOOST_AUTO_TEST_CASE(push_metatable)
     BOOST_CHECK_EQUAL(lua_gettop(env), 1);
 }
 
+BOOST_AUTO_TEST_CASE(cached_metatables)
+{
+    auto env = lua::create();
+
+    // Do values of the same type share a metatable?
+    lua::push(env, Counter(1));
+    lua::push(env, Counter(2));
+    lua_getmetatable(env, 1);
+    lua_getmetatable(env, 2);
+    BOOST_CHECK(lua_rawequal(env, -1, -2));
+    lua::clear(env);
+
+    // Are shared_ptr's to unnamed types cached?
+    lua::push(env, std::make_shared<Point<int>>(2, 2));
+    lua::push(env, std::make_shared<Point<int>>(3, 3));
+    lua_getmetatable(env, 1);
+    lua_getmetatable(env, 2);
+    BOOST_CHECK(lua_rawequal(env, -1, -2));
+    lua::clear(env);
+
+    // Are std::functions of the same signature cached?
+    lua::push(env, std::function<int(int)>([](int a) { return a; }));
+    lua::push(env, std::function<int(int)>([](int a) { return -a; }));
+    lua::push(env, std::function<double(double)>([](double a) { return a; }));
+    lua_getupvalue(env, 1, 1);
+    lua_getmetatable(env, -1);
+    lua_getupvalue(env, 2, 1);
+    lua_getmetatable(env, -1);
+    lua_getupvalue(env, 3, 1);
+    lua_getmetatable(env, -1);
+    BOOST_CHECK(lua_rawequal(env, 5, 7));
+
+    // Do different signatures still get their own metatable?
+    BOOST_CHECK(!lua_rawequal(env, 5, 9));
+}
+
 BOOST_AUTO_TEST_CASE(lambda_with_wrap)
 {
     auto env = lua::create();
@@ -504,10 +558,22 @@ BOOST_AUTO_TEST_CASE(call_lua_from_cpp)
 }
 
 struct MethodSum {
+    int base;
+
+    MethodSum() :
+        base(0)
+    {
+    }
+
     int sum(int a, int b)
     {
         return a + b;
     }
+
+    int sum_with_base(int a) const
+    {
+        return base + a;
+    }
 };
 
 BOOST_AUTO_TEST_CASE(call_cpp_methods)
@@ -518,6 +584,1070 @@ BOOST_AUTO_TEST_CASE(call_cpp_methods)
 
     auto result = lua::run_string<int>(env, "return sum(nil, 2, 3)");
     BOOST_CHECK_EQUAL(result, 5);
+
+    MethodSum summer;
+    summer.base = 40;
+    env["summer"] = &summer;
+    env["sum_with_base"] = &MethodSum::sum_with_base;
+    BOOST_CHECK_EQUAL(42, lua::run_string<int>(env, "return sum_with_base(summer, 2)"));
+
+    // Do methods require their object?
+    BOOST_CHECK_THROW(lua::run_string(env, "sum_with_base()"), lua::error);
+}
+
+BOOST_AUTO_TEST_CASE(function_pointer_upvalues)
+{
+    auto env = lua::create();
+
+    // Are function pointers saved directly, without a std::function?
+    lua::push(env, addNumbers);
+    lua_getupvalue(env, 1, 1);
+    BOOST_CHECK(lua::index(env, 2).type().userdata());
+    BOOST_CHECK_EQUAL(sizeof(&addNumbers), lua_rawlen(env, 2));
+    BOOST_CHECK(!lua_getmetatable(env, 2));
+    lua::clear(env);
+
+    lua::push(env, &MethodSum::sum);
+    lua_getupvalue(env, 1, 1);
+    BOOST_CHECK_EQUAL(sizeof(&MethodSum::sum), lua_rawlen(env, 2));
+    BOOST_CHECK(!lua_getmetatable(env, 2));
+}
+
+// Counts its copies and moves, and deliberately has no default constructor.
+struct CopyCounter
+{
+    static int copies;
+    static int moves;
+
+    int value;
+
+    CopyCounter(const int value) :
+        value(value)
+    {
+    }
+
+    CopyCounter(const CopyCounter& other) :
+        value(other.value)
+    {
+        ++copies;
+    }
+
+    CopyCounter(CopyCounter&& other) :
+        value(other.value)
+    {
+        ++moves;
+    }
+
+    static void reset()
+    {
+        copies = 0;
+        moves = 0;
+    }
+};
+
+int CopyCounter::copies = 0;
+int CopyCounter::moves = 0;
+
+static CopyCounter makeCopyCounter(int value)
+{
+    return CopyCounter(value);
+}
+
+static int readCopyCounter(const CopyCounter& counter)
+{
+    return counter.value;
+}
+
+static int takeCopyCounter(CopyCounter counter)
+{
+    return counter.value;
+}
+
+BOOST_AUTO_TEST_CASE(forwarding_and_moves)
+{
+    auto env = lua::create();
+
+    // Are temporaries moved into their userdata?
+    CopyCounter::reset();
+    lua::push(env, CopyCounter(1));
+    env["counter"] = CopyCounter(2);
+    lua::make<CopyCounter>(env, 3);
+    BOOST_CHECK_EQUAL(0, CopyCounter::copies);
+    lua::clear(env);
+
+    // Are return values moved onto the stack?
+    env["makeCopyCounter"] = makeCopyCounter;
+    CopyCounter::reset();
+    lua::run_string(env, "made = makeCopyCounter(42)");
+    BOOST_CHECK_EQUAL(0, CopyCounter::copies);
+
+    // Are references passed without copying?
+    env["readCopyCounter"] = readCopyCounter;
+    CopyCounter::reset();
+    BOOST_CHECK_EQUAL(42, lua::run_string<int>(env, "return readCopyCounter(made)"));
+    BOOST_CHECK_EQUAL(0, CopyCounter::copies);
+
+    // Are by-value parameters copied from the userdata only once?
+    env["takeCopyCounter"] = takeCopyCounter;
+    CopyCounter::reset();
+    BOOST_CHECK_EQUAL(42, lua::run_string<int>(env, "return takeCopyCounter(made)"));
+    BOOST_CHECK_EQUAL(1, CopyCounter::copies);
+
+    // Are std::function parameters treated the same way?
+    env["takeCopyCounterFunction"] = std::function<int(CopyCounter)>(takeCopyCounter);
+    CopyCounter::reset();
+    BOOST_CHECK_EQUAL(42, lua::run_string<int>(env, "return takeCopyCounterFunction(made)"));
+    BOOST_CHECK_EQUAL(1, CopyCounter::copies);
+
+    // Can values be retrieved without a default constructor?
+    CopyCounter::reset();
+    auto made = env["made"].get<CopyCounter>();
+    BOOST_CHECK_EQUAL(42, made.value);
+    BOOST_CHECK_EQUAL(1, CopyCounter::copies);
+}
+
+static std::string reverseString(const std::string& source)
+{
+    return std::string(source.rbegin(), source.rend());
+}
+
+BOOST_AUTO_TEST_CASE(binary_strings)
+{
+    auto env = lua::create();
+
+    // Are embedded NULs kept when pushing?
+    const std::string payload("No\0time\0", 9);
+    lua::push(env, payload);
+    BOOST_CHECK_EQUAL(9, lua_rawlen(env, -1));
+
+    // And when retrieving?
+    BOOST_CHECK(payload == lua::get<std::string>(env, -1));
+    BOOST_CHECK(payload == lua::get<const std::string&>(env, -1));
+    lua::clear(env);
+
+    // Can temporaries be pushed?
+    env["payload"] = std::string("\0\1\2", 3);
+    BOOST_CHECK_EQUAL(3, lua::run_string<int>(env, "return #payload"));
+
+    // Do C++ functions see the whole string?
+    env["reverseString"] = reverseString;
+    BOOST_CHECK_EQUAL(3, lua::run_string<int>(env, "return #reverseString(payload)"));
+    BOOST_CHECK(lua::run_string<bool>(env, "return reverseString(payload) == '\\2\\1\\0'"));
+
+    // Are numbers still read as strings, without changing the original?
+    lua::push(env, 42);
+    BOOST_CHECK_EQUAL("42", lua::get<std::string>(env, -1));
+    BOOST_CHECK(lua::index(env, -1).type().number());
+
+#ifdef LUACXX_HAVE_STRING_VIEW
+    // Do views point into the Lua string?
+    lua::push(env, payload);
+    auto view = lua::get<std::string_view>(env, -1);
+    BOOST_CHECK_EQUAL(9, view.size());
+    BOOST_CHECK_EQUAL(lua_tostring(env, -1), view.data());
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(interned_keys)
+{
+    auto env = lua::create();
+
+    lua::run_string(env, "config = { width = 640, height = 480 }");
+
+    // Can keys be used for globals and table fields?
+    lua::key config(env, "config");
+    lua::key width(env, "width");
+    BOOST_CHECK_EQUAL(640, env[config][width].get<int>());
+    BOOST_CHECK_EQUAL(480, lua::table::get<int>(env[config], lua::key(env, "height")));
+
+    // Are the same strings given the same slot?
+    BOOST_CHECK_EQUAL(width.id(), lua::key(env, std::string("width")).id());
+    BOOST_CHECK(config.id() != width.id());
+
+    // Can values be set through keys?
+    env[config][width] = 800;
+    BOOST_CHECK_EQUAL(800, lua::run_string<int>(env, "return config.width"));
+    env[lua::key(env, "depth")] = 24;
+    BOOST_CHECK_EQUAL(24, lua::run_string<int>(env, "return depth"));
+
+    // Do keys survive garbage collection, and leave the stack alone?
+    lua::clear(env);
+    lua_gc(env, LUA_GCCOLLECT, 0);
+    BOOST_CHECK_EQUAL(800, env[config][width].get<int>());
+    lua::key(env, "width");
+    lua::key(env, "length");
+    BOOST_CHECK_EQUAL(0, lua_gettop(env));
+
+    // Do globals named by keys keep their name?
+    BOOST_CHECK_EQUAL("config", env[config].name());
+    BOOST_CHECK_EQUAL("config", config.name());
+
+    // Can keys be used from threads of their state, but not by other states?
+    auto thread = lua_newthread(env);
+    BOOST_CHECK_EQUAL(800, lua::global(thread, config)[width].get<int>());
+    lua::clear(env);
+
+    auto other = lua::create();
+    lua::run_string(other, "config = { width = 1 }");
+    BOOST_CHECK_THROW(other[config], lua::error);
+    BOOST_CHECK_THROW(lua::push(other, width), lua::error);
+    BOOST_CHECK_EQUAL(0, lua_gettop(other));
+}
+
+BOOST_AUTO_TEST_CASE(pinned_paths)
+{
+    auto env = lua::create();
+
+    lua::run_string(env, "a = { b = { c = { d = 42 } } }");
+
+    // Can a nested path be pinned, and its fields used?
+    lua::pinned c(env["a"]["b"]["c"]);
+    BOOST_CHECK(c.resolved());
+    BOOST_CHECK(c.type().table());
+    BOOST_CHECK_EQUAL(42, c["d"].get<int>());
+    c["e"] = 24;
+    BOOST_CHECK_EQUAL(24, lua::run_string<int>(env, "return a.b.c.e"));
+
+    // Can the pinned value itself be retrieved?
+    lua::pinned d(c["d"]);
+    BOOST_CHECK_EQUAL(42, d.get<int>());
+
+    // Is the pinned value kept until it's invalidated?
+    lua::run_string(env, "a.b.c = { d = 96 }");
+    BOOST_CHECK_EQUAL(42, c["d"].get<int>());
+    auto copy = c;
+    copy.invalidate();
+    BOOST_CHECK(!c.resolved());
+    BOOST_CHECK_EQUAL(96, c["d"].get<int>());
+    BOOST_CHECK(copy.resolved());
+
+    // Do pinned values leave the stack alone?
+    lua::clear(env);
+    lua::pinned b(env["a"]["b"]);
+    b["f"] = 1;
+    BOOST_CHECK_EQUAL(1, b["f"].get<int>());
+    BOOST_CHECK_EQUAL(0, lua_gettop(env));
+}
+
+BOOST_AUTO_TEST_CASE(sequence_conversions)
+{
+    auto env = lua::create();
+
+    // Are numeric vectors pushed as arrays?
+    std::vector<double> samples { 0.5, 1.5, 2.5 };
+    env["samples"] = samples;
+    BOOST_CHECK_EQUAL(3, lua::run_string<int>(env, "return #samples"));
+    BOOST_CHECK_EQUAL(2.5, lua::run_string<double>(env, "return samples[3]"));
+
+    // Are they appended when stored?
+    std::vector<double> stored { -1 };
+    lua::store(stored, env["samples"]);
+    BOOST_REQUIRE_EQUAL(4, stored.size());
+    BOOST_CHECK_EQUAL(-1, stored[0]);
+    BOOST_CHECK_EQUAL(1.5, stored[2]);
+
+    // Do other element types keep their conversions?
+    lua::run_string(env, "mixed = { 1, '2', true }");
+    std::vector<int16_t> shorts;
+    lua::store(shorts, env["mixed"]);
+    BOOST_REQUIRE_EQUAL(3, shorts.size());
+    BOOST_CHECK_EQUAL(1, shorts[0]);
+    BOOST_CHECK_EQUAL(2, shorts[1]);
+
+    std::vector<bool> flags { true, false, true };
+    env["flags"] = flags;
+    BOOST_CHECK(lua::run_string<bool>(env, "return flags[1] and not flags[2] and flags[3]"));
+    std::vector<bool> stored_flags;
+    lua::store(stored_flags, env["flags"]);
+    BOOST_CHECK(flags == stored_flags);
+
+    std::vector<std::string> names { "a", "b" };
+    env["names"] = names;
+    BOOST_CHECK(names == env["names"].get<std::vector<std::string>>());
+
+    // Are arrays and deques supported?
+    std::array<uint8_t, 4> bytes {{ 1, 2, 3, 255 }};
+    env["bytes"] = bytes;
+    BOOST_CHECK_EQUAL(255, lua::run_string<int>(env, "return bytes[4]"));
+    std::array<uint8_t, 4> stored_bytes {{ 0, 0, 0, 0 }};
+    lua::store(stored_bytes, env["bytes"]);
+    BOOST_CHECK(bytes == stored_bytes);
+
+    std::array<float, 2> too_small;
+    BOOST_CHECK_THROW(lua::store(too_small, env["bytes"]), lua::error);
+
+    std::deque<long> history { 4, 5 };
+    env["history"] = history;
+    lua::store(history, env["history"]);
+    BOOST_REQUIRE_EQUAL(4, history.size());
+    BOOST_CHECK_EQUAL(5, history[3]);
+
+    // Are non-tables rejected?
+    env["samples"] = 42;
+    BOOST_CHECK_THROW(lua::store(stored, env["samples"]), lua::error);
+}
+
+BOOST_AUTO_TEST_CASE(buffers)
+{
+    auto env = lua::create();
+    luaopen_luacxx_buffer(env);
+
+    // Can buffers be created and indexed from Lua?
+    lua::run_string(env, "samples = buffer.float({ 1, 2, 3, 4, 5 })");
+    BOOST_CHECK_EQUAL(5, lua::run_string<int>(env, "return #samples"));
+    BOOST_CHECK_EQUAL(3, lua::run_string<float>(env, "return samples[3]"));
+    BOOST_CHECK(lua::run_string<bool>(env, "return samples[6] == nil"));
+    lua::run_string(env, "samples[1] = 10");
+    BOOST_CHECK_THROW(lua::run_string(env, "samples[6] = 1"), lua::error);
+
+    // Do bindings see the same memory?
+    auto& samples = env["samples"].get<lua::buffer<float>&>();
+    BOOST_REQUIRE_EQUAL(5, samples.size());
+    BOOST_CHECK_EQUAL(10, samples.data()[0]);
+    BOOST_CHECK_EQUAL(0, reinterpret_cast<uintptr_t>(samples.data()) % lua::buffer<float>::alignment);
+    samples[4] = 50;
+    BOOST_CHECK_EQUAL(50, lua::run_string<float>(env, "return samples[5]"));
+
+    // Do the bulk operations work?
+    BOOST_CHECK_EQUAL(69, lua::run_string<double>(env, "return samples:sum()"));
+    BOOST_CHECK_EQUAL(2, lua::run_string<float>(env, "return samples:min()"));
+    BOOST_CHECK_EQUAL(50, lua::run_string<float>(env, "return samples:max()"));
+    lua::run_string(env, "samples:clamp(0, 4)");
+    BOOST_CHECK_EQUAL(4, samples[0]);
+    lua::run_string(env, "samples:fill(2) samples:scale(3) samples:add(1)");
+    BOOST_CHECK_EQUAL(7, samples[2]);
+
+    lua::run_string(env, "ones = buffer.float(5) ones:fill(1)");
+    lua::run_string(env, "samples:add(ones) samples:multiply_add(ones, -2)");
+    BOOST_CHECK_EQUAL(6, samples[4]);
+    BOOST_CHECK_EQUAL(30, lua::run_string<double>(env, "return samples:dot(ones)"));
+    BOOST_CHECK_THROW(lua::run_string(env, "samples:dot(buffer.float(2))"), lua::error);
+    BOOST_CHECK_THROW(lua::run_string(env, "buffer.double(0):max()"), lua::error);
+
+    // Are conversions supported?
+    lua::run_string(env, "halves = buffer.double({ 1.5, -2.5 }) bytes = halves:convert('int8')");
+    BOOST_CHECK_EQUAL(-2, lua::run_string<int>(env, "return bytes[2]"));
+    BOOST_CHECK_EQUAL(2, lua::run_string<int>(env, "return #bytes:table()"));
+    BOOST_CHECK_THROW(lua::run_string(env, "halves:convert('string')"), lua::error);
+
+    auto wide = samples.convert<double>();
+    BOOST_CHECK_EQUAL(6, wide[0]);
+
+    // Can buffers be made from C++?
+    lua::buffer<uint16_t> counts(3);
+    counts.fill(7);
+    env["counts"] = counts;
+    BOOST_CHECK_EQUAL(21, lua::run_string<int>(env, "return counts:sum()"));
+
+    // Are buffers of other types, and other values, refused?
+    lua::run_string(env, "doubles = buffer.double(5)");
+    BOOST_CHECK_THROW(lua::run_string(env, "return samples:dot(doubles)"), lua::error);
+    BOOST_CHECK_THROW(lua::run_string(env, "samples:add(doubles)"), lua::error);
+    BOOST_CHECK_THROW(lua::run_string(env, "samples:multiply_add(doubles, 2)"), lua::error);
+    BOOST_CHECK_THROW(lua::run_string(env, "samples:add({})"), lua::error);
+    BOOST_CHECK_THROW(lua::run_string(env, "samples.size(doubles)"), lua::error);
+    BOOST_CHECK_EQUAL(6, samples[4]);
+
+    // Are names and fractions refused as indices?
+    BOOST_CHECK_THROW(lua::run_string(env, "samples.x = 7"), lua::error);
+    BOOST_CHECK_THROW(lua::run_string(env, "samples[1.5] = 7"), lua::error);
+    BOOST_CHECK_EQUAL(6, samples[0]);
+
+    // Are invalid sizes refused before anything is allocated?
+    BOOST_CHECK_THROW(lua::run_string(env, "buffer.double(-1)"), lua::error);
+    BOOST_CHECK_THROW(lua::run_string(env, "buffer.double(0/0)"), lua::error);
+    BOOST_CHECK_THROW(lua::run_string(env, "buffer.double(1.5)"), lua::error);
+    BOOST_CHECK_THROW(lua::run_string(env, "buffer.double(1e300)"), lua::error);
+    BOOST_CHECK_THROW(lua::run_string(env, "buffer.double('many')"), lua::error);
+    lua::clear(env);
+
+    // Are 64-bit elements kept whole, rather than truncated to Lua's width?
+    lua::run_string(env, "wide = buffer.uint64(1) wide[1] = 2^40 + 9");
+    BOOST_CHECK_EQUAL(1099511627785ull, env["wide"].get<lua::buffer<uint64_t>&>()[0]);
+    BOOST_CHECK(lua::run_string<bool>(env, "return wide[1] == 2^40 + 9"));
+    BOOST_CHECK(lua::run_string<bool>(env, "return buffer.uint64({ 2^50 }):max() == 2^50"));
+
+    // Are values a conversion can't hold clamped to the new type's range?
+    lua::run_string(env, "clamped = buffer.float({ 1e10, -1e10, 0/0, 7 }):convert('int8')");
+    auto& clamped = env["clamped"].get<lua::buffer<int8_t>&>();
+    BOOST_CHECK_EQUAL(127, clamped[0]);
+    BOOST_CHECK_EQUAL(-128, clamped[1]);
+    BOOST_CHECK_EQUAL(0, clamped[2]);
+    BOOST_CHECK_EQUAL(7, clamped[3]);
+    BOOST_CHECK_EQUAL(0, lua::run_string<int>(env, "return buffer.double({ -5 }):convert('uint32')[1]"));
+}
+
+BOOST_AUTO_TEST_CASE(buffer_accounting)
+{
+    auto accounting = new lua::accounting_allocator;
+    auto env = lua::create(std::unique_ptr<lua::allocator>(accounting));
+    luaopen_luacxx_buffer(env);
+
+    // Do buffers created from Lua count towards the state's memory?
+    auto before = accounting->used();
+    lua::run_string(env, "samples = buffer.double(100000)");
+    BOOST_CHECK(accounting->used() >= before + 100000 * sizeof(double));
+    auto& samples = env["samples"].get<lua::buffer<double>&>();
+    BOOST_CHECK_EQUAL(0, reinterpret_cast<uintptr_t>(samples.data()) % lua::buffer<double>::alignment);
+    BOOST_CHECK_EQUAL(0, samples[99999]);
+
+    env["samples"] = lua::value::nil;
+    lua_gc(env, LUA_GCCOLLECT, 0);
+    BOOST_CHECK(accounting->used() < before + 100000 * sizeof(double));
+
+    // Does the limit apply to them?
+    accounting->set_limit(accounting->used() + 64 * 1024);
+    BOOST_CHECK_THROW(lua::run_string(env, "buffer.double(1e8)"), lua::error);
+    BOOST_CHECK(accounting->failures() > 0);
+    accounting->set_limit(0);
+
+    lua::run_string(env, "halves = buffer.float(4):convert('double')");
+    BOOST_CHECK_EQUAL(4, lua::run_string<int>(env, "return #halves"));
+}
+
+struct ViewedSamples
+{
+    static int instances;
+    std::vector<double> values;
+
+    ViewedSamples()
+    {
+        ++instances;
+    }
+
+    ~ViewedSamples()
+    {
+        --instances;
+    }
+};
+
+int ViewedSamples::instances = 0;
+
+BOOST_AUTO_TEST_CASE(sequence_views)
+{
+    auto env = lua::create();
+
+    // Does Lua see the container itself?
+    std::vector<double> samples { 0.5, 1.5, 2.5 };
+    env["samples"] = lua::view(&samples);
+    BOOST_CHECK_EQUAL(3, lua::run_string<int>(env, "return #samples"));
+    BOOST_CHECK_EQUAL(1.5, lua::run_string<double>(env, "return samples[2]"));
+    BOOST_CHECK(lua::run_string<bool>(env, "return samples[4] == nil"));
+
+    samples[2] = 10;
+    BOOST_CHECK_EQUAL(10, lua::run_string<double>(env, "return samples[3]"));
+
+    // Are changes made in place?
+    lua::run_string(env, "samples[1] = 42; samples[#samples + 1] = 4");
+    BOOST_REQUIRE_EQUAL(4, samples.size());
+    BOOST_CHECK_EQUAL(42, samples[0]);
+    BOOST_CHECK_EQUAL(4, samples[3]);
+    BOOST_CHECK_THROW(lua::run_string(env, "samples[10] = 1"), lua::error);
+
+    lua::run_string(env, "samples:insert(1, -1); samples:remove(2); samples:append(5)");
+    BOOST_REQUIRE_EQUAL(5, samples.size());
+    BOOST_CHECK_EQUAL(-1, samples[0]);
+    BOOST_CHECK_EQUAL(5, samples[4]);
+
+    // Does ipairs see every element?
+    BOOST_CHECK_EQUAL(19.5, lua::run_string<double>(env,
+        "local sum = 0; for i, v in ipairs(samples) do sum = sum + v end; return sum"
+    ));
+    BOOST_CHECK_EQUAL(5, lua::run_string<int>(env, "return #samples:table()"));
+
+    // Do bindings receive the same container?
+    auto& view = env["samples"].get<lua::sequence_view<std::vector<double>>&>();
+    BOOST_CHECK_EQUAL(&samples, &view.container());
+
+    // Can views own their container?
+    auto names = std::make_shared<std::deque<std::string>>();
+    env["names"] = lua::view(names);
+    lua::run_string(env, "names:append('a'); names[2] = 'b'");
+    names.reset();
+    BOOST_CHECK_EQUAL("b", lua::run_string<std::string>(env, "return names[2]"));
+    lua::run_string(env, "names:clear()");
+    BOOST_CHECK_EQUAL(0, lua::run_string<int>(env, "return names:size()"));
+
+    // Are names and fractions refused as indices?
+    BOOST_CHECK_THROW(lua::run_string(env, "samples.x = 7"), lua::error);
+    BOOST_CHECK_THROW(lua::run_string(env, "samples[1.5] = 7"), lua::error);
+    BOOST_CHECK_EQUAL(5, samples.size());
+
+    // Does each container type have its own class name?
+    lua::clear(env);
+    lua::run_string(env, "return samples, names");
+    BOOST_CHECK_EQUAL("lua::sequence_view<std::vector<double>>", lua::class_name(env, 1));
+    BOOST_CHECK_EQUAL("lua::sequence_view<std::deque<std::string>>", lua::class_name(env, 2));
+    BOOST_CHECK(!lua::is_type<lua::sequence_view<std::deque<std::string>>>(env, 1));
+    lua::clear(env);
+
+    // Do views of a userdata's members keep the userdata alive?
+    auto owner = lua::make<ViewedSamples>(env);
+    owner->values = { 1, 2, 3 };
+    lua::push_view(env, &owner->values, -1);
+    lua_getuservalue(env, -1);
+    BOOST_CHECK_EQUAL(LUA_TTABLE, lua_type(env, -1));
+    lua_pop(env, 1);
+    env["owned"] = lua::index(env, -1);
+    lua::clear(env);
+    lua_gc(env, LUA_GCCOLLECT, 0);
+    BOOST_CHECK_EQUAL(1, ViewedSamples::instances);
+    BOOST_CHECK_EQUAL(6, lua::run_string<double>(env, "return owned[1] + owned[2] + owned[3]"));
+    env["owned"] = lua::value::nil;
+    lua_gc(env, LUA_GCCOLLECT, 0);
+    BOOST_CHECK_EQUAL(0, ViewedSamples::instances);
+}
+
+BOOST_AUTO_TEST_CASE(table_views)
+{
+    auto env = lua::create();
+
+    lua::run_string(env, "return { 1, 2, 3, 4 }, { a = 1, b = 2, c = 3, [1] = 4 }");
+    BOOST_REQUIRE_EQUAL(2, lua_gettop(env));
+
+    // Are sequences read lazily, in order?
+    lua::table_view<int> sequence(lua::index(env, 1));
+    BOOST_CHECK_EQUAL(4, sequence.size());
+    BOOST_CHECK_EQUAL(3, sequence[2]);
+    int sum = 0;
+    int previous = 0;
+    for (auto value : sequence) {
+        BOOST_CHECK(value > previous);
+        previous = value;
+        sum += value;
+    }
+    BOOST_CHECK_EQUAL(10, sum);
+    BOOST_CHECK_EQUAL(2, lua_gettop(env));
+
+    // Are all pairs visited, with the stack left as it was?
+    std::map<std::string, int> fields;
+    for (auto pair : lua::table_map_view<std::string, int>(lua::index(env, 2))) {
+        fields[pair.first] = pair.second;
+        BOOST_CHECK_EQUAL(5, lua_gettop(env));
+    }
+    BOOST_CHECK_EQUAL(4, fields.size());
+    BOOST_CHECK_EQUAL(3, fields["c"]);
+
+    // Was the numeric key converted without disturbing lua_next?
+    BOOST_CHECK_EQUAL(4, fields["1"]);
+    BOOST_CHECK_EQUAL(2, lua_gettop(env));
+
+    // Does leaving early, or pushing in the loop, keep the stack balanced?
+    int visited = 0;
+    for (auto pair : lua::table_map_view<std::string, int>(lua::index(env, 2))) {
+        lua::push(env, pair.second);
+        if (++visited == 2) {
+            break;
+        }
+    }
+    BOOST_CHECK_EQUAL(2, visited);
+    BOOST_CHECK_EQUAL(4, lua_gettop(env));
+    lua_settop(env, 2);
+
+    // Are userdata referenced in place?
+    lua_newtable(env);
+    lua::push(env, Counter(1));
+    lua_rawseti(env, -2, 1);
+    lua::push(env, Counter(2));
+    lua_rawseti(env, -2, 2);
+    Counter* first = nullptr;
+    for (auto& counter : lua::table_view<Counter&>(lua::index(env, -1))) {
+        if (!first) {
+            first = &counter;
+        }
+    }
+    lua_rawgeti(env, -1, 1);
+    BOOST_CHECK_EQUAL(first, lua::get<Counter*>(env, -1));
+
+    BOOST_CHECK_THROW(lua::table_view<int>(lua::index(env, -1)), lua::error);
+}
+
+BOOST_AUTO_TEST_CASE(table_builders)
+{
+    auto env = lua::create();
+
+    // Are values appended and set in place?
+    lua::table_builder builder(env, 3, 1);
+    builder.append(1).append("two").set("name", "builder");
+    lua_pushboolean(env, true);
+    lua_pop(env, 1);
+    builder.append(3.5);
+    BOOST_CHECK_EQUAL(3, builder.length());
+    BOOST_CHECK_EQUAL(1, lua_gettop(env));
+    env["built"] = builder.table();
+    lua_settop(env, 0);
+
+    BOOST_CHECK_EQUAL(3, lua::run_string<int>(env, "return #built"));
+    BOOST_CHECK_EQUAL("two", lua::run_string<std::string>(env, "return built[2]"));
+    BOOST_CHECK_EQUAL("builder", lua::run_string<std::string>(env, "return built.name"));
+    lua_settop(env, 0);
+
+    // Do existing tables continue from their length?
+    lua::push(env, env["built"]);
+    lua::table_builder(lua::index(env, 1)).append(4);
+    BOOST_CHECK_EQUAL(4, lua::run_string<int>(env, "return #built"));
+    lua_settop(env, 0);
+
+    // Are keys Lua can't use refused, rather than raised outside a call?
+    lua::table_builder checked(env);
+    BOOST_CHECK_THROW(checked.set(lua::value::nil, 1), lua::error);
+    BOOST_CHECK_THROW(checked.set(std::numeric_limits<double>::quiet_NaN(), 1), lua::error);
+    BOOST_CHECK_EQUAL(1, lua_gettop(env));
+
+    // Is the key popped when its value can't be pushed?
+    std::map<double, int> unusable { { std::numeric_limits<double>::quiet_NaN(), 1 } };
+    BOOST_CHECK_THROW(checked.set("unusable", unusable), lua::error);
+    BOOST_CHECK_EQUAL(1, lua_gettop(env));
+    checked.set(2.5, "fine");
+    env["checked"] = checked.table();
+    lua_settop(env, 0);
+    BOOST_CHECK_EQUAL(1, lua::run_string<int>(env, "local n = 0 for k in pairs(checked) do n = n + 1 end return n"));
+    lua_settop(env, 0);
+
+    // Are maps converted in both directions?
+    std::map<std::string, int> sizes { { "width", 640 }, { "height", 480 } };
+    env["sizes"] = sizes;
+    BOOST_CHECK_EQUAL(480, lua::run_string<int>(env, "return sizes.height"));
+
+    lua::run_string(env, "sizes.depth = 32");
+    std::map<std::string, int> stored { { "width", 1 }, { "stale", 2 } };
+    lua::store(stored, env["sizes"]);
+    BOOST_CHECK_EQUAL(3, stored.size());
+    BOOST_CHECK_EQUAL(0, stored.count("stale"));
+    BOOST_CHECK_EQUAL(640, stored["width"]);
+    BOOST_CHECK_EQUAL(32, stored["depth"]);
+
+    std::unordered_map<int, std::string> names { { 1, "a" }, { 2, "b" } };
+    env["names"] = names;
+    BOOST_CHECK_EQUAL(2, lua::run_string<int>(env, "return #names"));
+    std::unordered_map<int, std::string> stored_names;
+    lua::store(stored_names, env["names"]);
+    BOOST_CHECK(names == stored_names);
+
+    env["sizes"] = 42;
+    BOOST_CHECK_THROW(lua::store(stored, env["sizes"]), lua::error);
+}
+
+static std::tuple<bool, int, std::string> divide_with_remainder(const int a, const int b)
+{
+    if (b == 0) {
+        return std::make_tuple(false, 0, "Division by zero");
+    }
+    return std::make_tuple(true, a / b, std::to_string(a % b));
+}
+
+static std::pair<int, int> state_pair(lua_State* const state)
+{
+    return std::make_pair(lua::get<int>(state, 1), lua_gettop(state));
+}
+
+BOOST_AUTO_TEST_CASE(multiple_returns)
+{
+    auto env = lua::create();
+
+    // Are tuples returned as several values?
+    env["divide"] = divide_with_remainder;
+    lua::run_string(env, "ok, quotient, remainder = divide(7, 2)");
+    BOOST_CHECK_EQUAL(true, env["ok"].get<bool>());
+    BOOST_CHECK_EQUAL(3, env["quotient"].get<int>());
+    BOOST_CHECK_EQUAL("1", env["remainder"].get<std::string>());
+    BOOST_CHECK_EQUAL(3, lua::run_string<int>(env, "return select('#', divide(1, 0))"));
+
+    // Are pairs, and other kinds of callables, supported?
+    env["swap"] = std::function<std::pair<std::string, int>(int, std::string)>(
+        [](int a, std::string b) {
+            return std::make_pair(b, a);
+        }
+    );
+    BOOST_CHECK_EQUAL("b1", lua::run_string<std::string>(env, "local a, b = swap(1, 'b'); return a .. b"));
+
+    env["state_pair"] = state_pair;
+    BOOST_CHECK_EQUAL(45, lua::run_string<int>(env, "local a, b = state_pair(4, 0, 0, 0, 0); return a * 10 + b"));
+
+    env["overloaded"] = lua::overload()
+        .add<std::tuple<bool, int, std::string>(*)(int, int)>(divide_with_remainder);
+    BOOST_CHECK_EQUAL("2", lua::run_string<std::string>(env, "return select(3, overloaded(8, 3))"));
+}
+
+struct CountingAllocator : public lua::pool_allocator
+{
+    static int instances;
+    size_t calls;
+
+    CountingAllocator() :
+        calls(0)
+    {
+        ++instances;
+    }
+
+    ~CountingAllocator()
+    {
+        --instances;
+    }
+
+    void* reallocate(void* const ptr, const size_t old_size, const size_t new_size) override
+    {
+        ++calls;
+        return lua::pool_allocator::reallocate(ptr, old_size, new_size);
+    }
+};
+
+int CountingAllocator::instances = 0;
+
+BOOST_AUTO_TEST_CASE(allocators)
+{
+    {
+        auto allocator = new CountingAllocator;
+        auto env = lua::create(std::unique_ptr<lua::allocator>(allocator));
+        BOOST_CHECK_EQUAL(1, CountingAllocator::instances);
+        BOOST_CHECK(allocator->calls > 0);
+
+        // Do small and large objects, and growing strings and tables, survive?
+        lua::run_string(env,
+            "local parts = {}\n"
+            "for i = 1, 2000 do\n"
+            "    parts[#parts + 1] = { i, tostring(i), function() return i end }\n"
+            "end\n"
+            "local big = string.rep('x', 1000)\n"
+            "for i = 1, 10 do big = big .. big:sub(1, 100) end\n"
+            "collectgarbage()\n"
+            "total = 0\n"
+            "for _, part in ipairs(parts) do total = total + part[3]() + #part[2] end\n"
+            "length = #big\n"
+        );
+        BOOST_CHECK_EQUAL(2001000 + 6893, env["total"].get<int>());
+        BOOST_CHECK_EQUAL(2000, env["length"].get<int>());
+
+        lua::push(env, Counter(42));
+        BOOST_CHECK_EQUAL(42, lua::get<Counter&>(env, -1).get());
+    }
+
+    // Is the allocator deleted once its state is closed?
+    BOOST_CHECK_EQUAL(0, CountingAllocator::instances);
+}
+
+BOOST_AUTO_TEST_CASE(memory_accounting)
+{
+    auto accounting = new lua::accounting_allocator;
+    auto env = lua::create(std::unique_ptr<lua::allocator>(accounting));
+    BOOST_CHECK_EQUAL(accounting, lua::accounting(env));
+    BOOST_CHECK(accounting->used() > 0);
+    BOOST_CHECK(accounting->allocations() > accounting->frees());
+
+    // Does the state account for what it allocates, and what it frees?
+    auto before = accounting->used();
+    std::string code(
+        "garbage = {}\n"
+        "for i = 1, 1000 do garbage[i] = string.rep('x', 100) .. i end\n"
+    );
+    lua::run_string(env, code);
+    BOOST_CHECK(accounting->used() > before + 100000);
+    BOOST_CHECK(accounting->histogram(3) >= 1000);
+    env["garbage"] = lua::value::nil;
+    lua_gc(env, LUA_GCCOLLECT, 0);
+    BOOST_CHECK(accounting->used() < before + 100000);
+    BOOST_CHECK(accounting->peak() > before + 100000);
+
+    // Are the counters visible from Lua?
+    luaopen_luacxx_memory(env);
+    lua::clear(env);
+    lua::run_string(env, "return memory.used(), memory.peak(), memory.histogram()[128]");
+    BOOST_CHECK(lua::get<size_t>(env, 1) > 0);
+    BOOST_CHECK_EQUAL(accounting->peak(), lua::get<size_t>(env, 2));
+    BOOST_CHECK_EQUAL(accounting->histogram(3), lua::get<size_t>(env, 3));
+    lua::clear(env);
+
+    // Does the limit fail allocations as a memory error?
+    accounting->set_limit(accounting->used() + 64 * 1024);
+    std::string runaway(
+        "local t = {}\n"
+        "for i = 1, 1e6 do t[i] = string.rep('y', 100) .. i end\n"
+    );
+    lua::load_string(env, runaway);
+    BOOST_CHECK_THROW(lua::invoke(lua::index(env, -1)), std::runtime_error);
+    BOOST_CHECK(accounting->failures() > 0);
+    BOOST_CHECK(accounting->used() <= accounting->limit());
+    lua::clear(env);
+
+    // Does the state still work once the memory is freed?
+    lua_gc(env, LUA_GCCOLLECT, 0);
+    lua::run_string(env, "return 1 + 2");
+    BOOST_CHECK_EQUAL(3, lua::get<int>(env, -1));
+
+    // States without an accounting_allocator don't have one
+    auto plain = lua::create();
+    BOOST_CHECK(!lua::accounting(plain));
+}
+
+struct Specimen
+{
+    int value;
+};
+
+namespace lua {
+
+template <>
+struct Metatable<Specimen>
+{
+    static constexpr const char* name = "Specimen";
+
+    static bool metatable(const lua::index& mt, Specimen* const)
+    {
+        return true;
+    }
+};
+
+} // namespace lua
+
+BOOST_AUTO_TEST_CASE(userdata_census)
+{
+    auto counters = []() {
+        for (auto& entry : lua::census()) {
+            if (entry.name == std::string("Specimen")) {
+                return entry;
+            }
+        }
+        return lua::census_entry { "Specimen", 0, 0 };
+    };
+
+    auto env = lua::create();
+    auto before = counters();
+
+    // Are userdata counted by their class as they're created?
+    Specimen specimen { 3 };
+    lua::table_builder specimens(env, 102, 0);
+    for (int i = 0; i < 100; ++i) {
+        specimens.append(Specimen { i });
+    }
+    specimens.append(&specimen);
+    specimens.append(std::make_shared<Specimen>());
+    BOOST_CHECK_EQUAL(before.live + 102, counters().live);
+    BOOST_CHECK_EQUAL(
+        before.bytes + 100 * (lua::userdata_block_size + sizeof(Specimen))
+            + lua::userdata_block_size + sizeof(Specimen*)
+            + lua::userdata_block_size + sizeof(std::shared_ptr<Specimen>),
+        counters().bytes
+    );
+    BOOST_CHECK(lua::dump_census().find("Specimen: 102 live") != std::string::npos);
+
+    // Are the same counts visible from Lua?
+    luaopen_luacxx_census(env);
+    std::string code("return census.counts().Specimen.live");
+    lua::run_string(env, code);
+    BOOST_CHECK_EQUAL(before.live + 102, lua::get<size_t>(env, -1));
+
+    // Are they uncounted once collected?
+    lua::clear(env);
+    lua_gc(env, LUA_GCCOLLECT, 0);
+    BOOST_CHECK_EQUAL(before.live, counters().live);
+    BOOST_CHECK_EQUAL(before.bytes, counters().bytes);
+}
+
+struct Tracked
+{
+    static int destructed;
+    static int destroyed;
+
+    ~Tracked()
+    {
+        ++destructed;
+    }
+};
+
+int Tracked::destructed = 0;
+int Tracked::destroyed = 0;
+
+struct TrackedWithDestroy : public Tracked
+{
+};
+
+void Tracked_destroy(TrackedWithDestroy& self)
+{
+    BOOST_CHECK_EQUAL(Tracked::destroyed, Tracked::destructed);
+    ++Tracked::destroyed;
+}
+
+namespace lua {
+
+template <>
+struct Metatable<TrackedWithDestroy>
+{
+    static constexpr const char* name = "TrackedWithDestroy";
+
+    static bool metatable(const lua::index& mt, TrackedWithDestroy* const)
+    {
+        mt["destroy"] = Tracked_destroy;
+        return true;
+    }
+};
+
+} // namespace lua
+
+BOOST_AUTO_TEST_CASE(userdata_collection)
+{
+    auto env = lua::create();
+
+    // Are values without a destroy method destroyed directly?
+    lua::push(env, Tracked());
+    lua::push(env, std::make_shared<Tracked>());
+    Tracked::destructed = 0;
+    lua::clear(env);
+    lua_gc(env, LUA_GCCOLLECT, 0);
+    BOOST_CHECK_EQUAL(2, Tracked::destructed);
+    BOOST_CHECK_EQUAL(0, Tracked::destroyed);
+
+    // Is destroy called before the value is destroyed?
+    lua::push(env, TrackedWithDestroy());
+    Tracked::destructed = 0;
+    lua::clear(env);
+    lua_gc(env, LUA_GCCOLLECT, 0);
+    BOOST_CHECK_EQUAL(1, Tracked::destroyed);
+    BOOST_CHECK_EQUAL(1, Tracked::destructed);
+
+    // Are pointers left alone?
+    Tracked tracked;
+    lua::push(env, &tracked);
+    Tracked::destructed = 0;
+    lua::clear(env);
+    lua_gc(env, LUA_GCCOLLECT, 0);
+    BOOST_CHECK_EQUAL(0, Tracked::destructed);
+}
+
+BOOST_AUTO_TEST_CASE(userdata_type_identification)
+{
+    auto env = lua::create();
+
+    // Are types identified by their userdata, however they were pushed?
+    lua::push(env, Counter(42));
+    Counter counter(24);
+    lua::push(env, &counter);
+    lua::push(env, std::make_shared<Counter>(12));
+    lua::push(env, Point<int>(2, 3));
+    for (int i = 1; i <= 3; ++i) {
+        BOOST_CHECK(lua::is_type<Counter>(env, i));
+        BOOST_CHECK(!lua::is_type<Point<int>>(env, i));
+    }
+    BOOST_CHECK(lua::is_type<Point<int>>(env, 4));
+    BOOST_CHECK_EQUAL(42, lua::get<Counter*>(env, 1)->get());
+    BOOST_CHECK_EQUAL(&counter, lua::get<Counter*>(env, 2));
+    BOOST_CHECK_EQUAL(sizeof(Counter), lua::userdata_size(lua::index(env, 1)));
+    lua::clear(env);
+
+    // Are other values, and userdata not created by Luacxx, ignored?
+    lua::push(env, 42);
+    std::memset(lua_newuserdata(env, 64), 0, 64);
+    lua_newuserdata(env, 1);
+    lua::run_string(env, "return io.stdout");
+    for (int i = 1; i <= 4; ++i) {
+        BOOST_CHECK(!lua::is_type<Counter>(env, i));
+        BOOST_CHECK(!lua::find_userdata_block(env, i));
+        BOOST_CHECK(!lua::class_id(env, i));
+    }
+    BOOST_CHECK_EQUAL(4, lua_gettop(env));
+    BOOST_CHECK_THROW(lua::get<Counter*>(env, 2), lua::error);
+}
+
+static std::string describeCounter(const Counter& counter)
+{
+    return "Counter";
+}
+
+static std::string describePoint(const Point<int>& point)
+{
+    return "Point";
+}
+
+static std::string describeNumbers(int a, int b)
+{
+    return "Numbers";
+}
+
+static std::string describeCounterPointer(Counter* counter)
+{
+    return counter ? "Counter*" : "nullptr";
+}
+
+enum class Shade {
+    light,
+    dark
+};
+
+static std::string describeShade(Shade shade)
+{
+    return shade == Shade::dark ? "dark" : "light";
+}
+
+struct Describer {
+    std::string describe(const std::string& name) const
+    {
+        return "string " + name;
+    }
+
+    std::string describe(int value)
+    {
+        return "number";
+    }
+};
+
+BOOST_AUTO_TEST_CASE(overloads)
+{
+    auto env = lua::create();
+
+    env["describe"] = lua::overload()
+        .add(describePoint)
+        .add(describeCounter)
+        .add(describeNumbers)
+        .add(std::function<std::string(int)>([](int a) {
+            return std::string("Number");
+        }));
+
+    env["counter"] = Counter(2);
+    env["point"] = Point<int>(2, 3);
+
+    // Are candidates chosen by their arguments, regardless of order?
+    BOOST_CHECK_EQUAL("Counter", lua::run_string<std::string>(env, "return describe(counter)"));
+    BOOST_CHECK_EQUAL("Point", lua::run_string<std::string>(env, "return describe(point)"));
+    BOOST_CHECK_EQUAL("Numbers", lua::run_string<std::string>(env, "return describe(1, 2)"));
+    BOOST_CHECK_EQUAL("Number", lua::run_string<std::string>(env, "return describe(1)"));
+
+    // Are bad calls reported?
+    BOOST_CHECK_THROW(lua::run_string(env, "describe('No time')"), lua::error);
+    BOOST_CHECK_THROW(lua::run_string(env, "describe('No time', 1, 2)"), lua::error);
+
+    // Are extra trailing arguments ignored?
+    BOOST_CHECK_EQUAL("Numbers", lua::run_string<std::string>(env, "return describe(1, 2, 3)"));
+    BOOST_CHECK_EQUAL("Counter", lua::run_string<std::string>(env, "return describe(counter, 'extra')"));
+
+    // Is a userdata of another class never accepted, even by a lone candidate?
+    env["describe_counter"] = lua::overload()
+        .add(describeCounter);
+    BOOST_CHECK_THROW(lua::run_string(env, "describe_counter(point)"), lua::error);
+
+    // Are enumerations accepted as userdata and as plain numbers?
+    env["describe_shade"] = lua::overload()
+        .add(describeShade)
+        .add(describeCounter);
+    env["dark"] = Shade::dark;
+    BOOST_CHECK_EQUAL("dark", lua::run_string<std::string>(env, "return describe_shade(dark)"));
+    BOOST_CHECK_EQUAL("dark", lua::run_string<std::string>(env, "return describe_shade(1)"));
+    BOOST_CHECK_EQUAL("Counter", lua::run_string<std::string>(env, "return describe_shade(counter)"));
+    BOOST_CHECK_THROW(lua::run_string(env, "describe_shade(point)"), lua::error);
+
+    // Are exact matches preferred to loose ones?
+    env["describe_pointer"] = lua::overload()
+        .add(describeCounterPointer)
+        .add(describePoint);
+    BOOST_CHECK_EQUAL("Point", lua::run_string<std::string>(env, "return describe_pointer(point)"));
+    BOOST_CHECK_EQUAL("Counter*", lua::run_string<std::string>(env, "return describe_pointer(counter)"));
+    BOOST_CHECK_EQUAL("nullptr", lua::run_string<std::string>(env, "return describe_pointer(nil)"));
+
+    // Do overloaded methods work?
+    env["describer"] = Describer();
+    env["method"] = lua::overload()
+        .add<std::string(Describer::*)(const std::string&) const>(&Describer::describe)
+        .add<std::string(Describer::*)(int)>(&Describer::describe);
+    BOOST_CHECK_EQUAL("number", lua::run_string<std::string>(env, "return method(describer, 42)"));
+    BOOST_CHECK_EQUAL("string foo", lua::run_string<std::string>(env, "return method(describer, 'foo')"));
 }
 
 BOOST_AUTO_TEST_CASE(call_lua_from_cpp_with_extra_arguments)
@@ -605,6 +1735,398 @@ BOOST_AUTO_TEST_CASE(error_support)
     BOOST_CHECK_NO_THROW(lua::run_string(env, "call(false, 1, 2, 3)"));
 }
 
+static int call_unprotected(lua_State* const state)
+{
+    lua::invoke_unprotected(lua::index(state, 1));
+    return lua_gettop(state);
+}
+
+BOOST_AUTO_TEST_CASE(persistent_error_handler)
+{
+    auto env = lua::create();
+    std::string code(
+        "function add(a, b) return a + b end\n"
+        "function fail() error('Intentional') end\n"
+    );
+    lua::run_string(env, code);
+    lua::clear(env);
+
+    // Is a pushed handler reused, and left in place, for several calls?
+    auto handler = lua::push_error_handler(env);
+    for (int i = 0; i < 3; ++i) {
+        lua::push(env, env["add"]);
+        lua::push(env, i, 10);
+        lua::invoke(lua::index(env, handler.pos() + 1));
+        BOOST_CHECK_EQUAL(2, lua_gettop(env));
+        BOOST_CHECK_EQUAL(i + 10, lua::get<int>(env, -1));
+        lua_settop(env, handler.pos());
+    }
+
+    // Are errors still reported through it?
+    lua::push(env, env["fail"]);
+    try {
+        lua::invoke(lua::index(env, handler.pos() + 1));
+        BOOST_FAIL("lua::invoke should have thrown");
+    } catch (lua::error& ex) {
+        BOOST_CHECK(std::string(ex.what()).find("Intentional") != std::string::npos);
+        BOOST_CHECK(std::string(ex.what()).find("stack traceback") != std::string::npos);
+    }
+    lua::clear(env);
+
+    // Does lua::call keep the stack as it was, besides its returned value?
+    BOOST_CHECK_EQUAL(5, lua::call<int>(env["add"], 2, 3));
+    BOOST_CHECK_EQUAL(1, lua_gettop(env));
+    lua::clear(env);
+    lua::call(env["add"], 2, 3);
+    BOOST_CHECK_EQUAL(0, lua_gettop(env));
+
+    // Is the stack restored when the call fails?
+    BOOST_CHECK_THROW(lua::call<int>(env["fail"]), lua::error);
+    BOOST_CHECK_EQUAL(0, lua_gettop(env));
+    BOOST_CHECK_THROW(lua::call(env["fail"]), lua::error);
+    BOOST_CHECK_EQUAL(0, lua_gettop(env));
+    BOOST_CHECK_THROW(lua::call(env["missing"]), lua::error);
+    BOOST_CHECK_EQUAL(0, lua_gettop(env));
+
+    // Are unprotected calls of other values refused?
+    lua::push(env, 42);
+    BOOST_CHECK_THROW(lua::invoke_unprotected(lua::index(env, 1)), lua::error);
+    lua::clear(env);
+
+    // Do unprotected calls raise errors to the enclosing protected call?
+    lua_pushcfunction(env, call_unprotected);
+    lua_setglobal(env, "call_unprotected");
+    std::string unprotected(
+        "local sum = call_unprotected(add, 1, 2)\n"
+        "local ok = pcall(call_unprotected, fail)\n"
+        "return sum, ok\n"
+    );
+    lua::run_string(env, unprotected);
+    BOOST_CHECK_EQUAL(3, lua::get<int>(env, 1));
+    BOOST_CHECK_EQUAL(false, lua::get<bool>(env, 2));
+}
+
+static int compare_tracebacks(lua_State* const state)
+{
+    lua::error ex("Comparison");
+    ex.set_traceback(lua::stack_frames(state, 1));
+    if (ex.frames().size() < 20) {
+        BOOST_CHECK_EQUAL(lua::traceback(state, 1), ex.traceback());
+    } else {
+        // Lua versions differ in how much of a deep stack they keep
+        BOOST_CHECK_EQUAL(12 + 1 + 11, ex.frames().size());
+        BOOST_CHECK_EQUAL('.', ex.frames()[12].what);
+        BOOST_CHECK_EQUAL('m', ex.frames().back().what);
+    }
+    return 0;
+}
+
+BOOST_AUTO_TEST_CASE(lazy_tracebacks)
+{
+    auto env = lua::create();
+    lua_pushcfunction(env, compare_tracebacks);
+    lua_setglobal(env, "compare_tracebacks");
+
+    // Do captured frames format like luaL_traceback, and skip deep stacks?
+    std::string code(
+        "local function recurse(n)\n"
+        "    if n == 0 then compare_tracebacks() return end\n"
+        "    recurse(n - 1)\n"
+        "end\n"
+        "recurse(2)\n"
+        "recurse(40)\n"
+        "local nested = function() return compare_tracebacks() end\n"
+        "nested()\n"
+        "function fail() error('Intentional') end\n"
+    );
+    lua::run_string(env, code);
+    lua::clear(env);
+
+    // Do errors carry their traceback?
+    try {
+        lua::call(env["fail"]);
+        BOOST_FAIL("lua::call should have thrown");
+    } catch (lua::error& ex) {
+        BOOST_CHECK(ex.has_traceback());
+        BOOST_CHECK(!ex.frames().empty());
+        BOOST_CHECK_EQUAL(0, ex.traceback().find("stack traceback:"));
+        BOOST_CHECK_EQUAL(ex.message() + "\n" + ex.traceback(), ex.what());
+    }
+    lua::clear(env);
+
+    // Can capturing be disabled?
+    BOOST_CHECK(lua::capturing_tracebacks(env));
+    lua::capture_tracebacks(env, false);
+    BOOST_CHECK(!lua::capturing_tracebacks(env));
+    try {
+        lua::call(env["fail"]);
+        BOOST_FAIL("lua::call should have thrown");
+    } catch (lua::error& ex) {
+        BOOST_CHECK(!ex.has_traceback());
+        BOOST_CHECK(std::string(ex.what()).find("Intentional") != std::string::npos);
+    }
+    lua::capture_tracebacks(env, true);
+    BOOST_CHECK(lua::capturing_tracebacks(env));
+}
+
+static int apply_twice(lua::function<int(int)> callback, const int value)
+{
+    return callback(callback(value));
+}
+
+BOOST_AUTO_TEST_CASE(typed_functions)
+{
+    auto env = lua::create();
+    std::string code(
+        "function add(a, b) return a + b end\n"
+        "function divmod(a, b) return math.floor(a / b), a % b end\n"
+        "function greet(name) return 'Hello, ' .. name end\n"
+        "function nothing() end\n"
+        "function fail() error('Intentional') end\n"
+        "answer = 42\n"
+    );
+    lua::run_string(env, code);
+    lua::clear(env);
+
+    // Are arguments and results converted, leaving the stack alone?
+    lua::function<int(int, int)> add(env["add"]);
+    BOOST_CHECK_EQUAL(5, add(2, 3));
+    BOOST_CHECK_EQUAL(0, lua_gettop(env));
+
+    lua::function<std::string(std::string)> greet(env["greet"]);
+    BOOST_CHECK_EQUAL("Hello, world", greet("world"));
+
+    // Are several results returned as a tuple?
+    lua::function<std::tuple<int, int>(int, int)> divmod(env["divmod"]);
+    int quotient = 0;
+    int remainder = 0;
+    std::tie(quotient, remainder) = divmod(7, 2);
+    BOOST_CHECK_EQUAL(3, quotient);
+    BOOST_CHECK_EQUAL(1, remainder);
+
+    // Is the function kept, even once its name is reused?
+    env["add"] = lua::value::nil;
+    BOOST_CHECK_EQUAL(9, add(4, 5));
+    auto copy = add;
+    BOOST_CHECK_EQUAL(3, copy(1, 2));
+
+    // Does assignment take its own reference, rather than sharing one?
+    lua::run_string(env, "function f(x) return x + 1 end function g(x) return x * 10 end");
+    lua::function<int(int, int)> assigned(env["divmod"]);
+    assigned = add;
+    assigned = assigned;
+    BOOST_CHECK(assigned.target().id() != add.target().id());
+    BOOST_CHECK_EQUAL(7, assigned(3, 4));
+    {
+        lua::function<int(int, int)> temporary(env["divmod"]);
+        temporary = add;
+    }
+    lua::function<int(int)> f(env["f"]);
+    lua::function<int(int)> g(env["g"]);
+    BOOST_CHECK(f.target().id() != g.target().id());
+    BOOST_CHECK(f.target().id() != add.target().id());
+    BOOST_CHECK_EQUAL(3, f(2));
+    BOOST_CHECK_EQUAL(20, g(2));
+    BOOST_CHECK_EQUAL(9, add(4, 5));
+    BOOST_CHECK_EQUAL(9, assigned(4, 5));
+
+    // Are missing results nil, and errors thrown with the stack restored?
+    lua::function<void()> nothing(env["nothing"]);
+    nothing();
+    lua::function<std::tuple<bool, std::string>()> missing(env["nothing"]);
+    BOOST_CHECK_EQUAL(false, std::get<0>(missing()));
+    lua::function<void()> fail(env["fail"]);
+    BOOST_CHECK_THROW(fail(), lua::error);
+    BOOST_CHECK_EQUAL(0, lua_gettop(env));
+
+    // Are non-functions refused, and empty handles reported?
+    BOOST_CHECK_THROW(lua::function<void()> answer(env["answer"]), lua::error);
+    lua::function<void()> empty;
+    BOOST_CHECK(!empty);
+    BOOST_CHECK_THROW(empty(), lua::error);
+
+    // Can functions be passed to C++ as typed callbacks?
+    env["apply_twice"] = apply_twice;
+    std::string apply("return apply_twice(function(x) return x * 3 end, 2)");
+    lua::run_string(env, apply);
+    BOOST_CHECK_EQUAL(18, lua::get<int>(env, -1));
+}
+
+BOOST_AUTO_TEST_CASE(batch_invocation)
+{
+    auto env = lua::create();
+    std::string code(
+        "function double(x) return x * 2 end\n"
+        "function fail_on_three(x) if x == 3 then error('Intentional') end return x end\n"
+        "seen = 0\n"
+        "function count(x) seen = seen + x end\n"
+    );
+    lua::run_string(env, code);
+    lua::clear(env);
+
+    // Are results collected into a container, in order?
+    std::vector<int> values { 1, 2, 3, 4 };
+    auto doubled = lua::map<std::vector<int>>(env["double"], values);
+    BOOST_REQUIRE_EQUAL(4, doubled.size());
+    BOOST_CHECK_EQUAL(2, doubled[0]);
+    BOOST_CHECK_EQUAL(8, doubled[3]);
+    BOOST_CHECK_EQUAL(0, lua_gettop(env));
+
+    // Or into a Lua table?
+    auto table = lua::map_table(env["double"], values);
+    BOOST_CHECK_EQUAL(1, lua_gettop(env));
+    BOOST_CHECK_EQUAL(4, lua_rawlen(env, table.pos()));
+    BOOST_CHECK_EQUAL(6, lua::table::get<int>(table, 3));
+    lua::clear(env);
+
+    // Is every value given, when results are ignored?
+    lua::for_each(env["count"], values);
+    BOOST_CHECK_EQUAL(10, env["seen"].get<int>());
+    BOOST_CHECK_EQUAL(0, lua_gettop(env));
+
+    // Are stack ranges accepted?
+    lua::push(env, 5, 6);
+    auto from_stack = lua::map<std::vector<int>>(env["double"], lua::range<int>(env));
+    BOOST_REQUIRE_EQUAL(2, from_stack.size());
+    BOOST_CHECK_EQUAL(12, from_stack[1]);
+    BOOST_CHECK_EQUAL(2, lua_gettop(env));
+    auto stack_table = lua::map_table(env["double"], lua::range<int>(env));
+    BOOST_CHECK_EQUAL(2, lua_rawlen(env, stack_table.pos()));
+    BOOST_CHECK_EQUAL(3, lua_gettop(env));
+    lua::clear(env);
+
+    // Do errors report the failing element, and restore the stack?
+    try {
+        lua::map_table(env["fail_on_three"], values);
+        BOOST_FAIL("lua::map_table should have thrown");
+    } catch (lua::batch_error& ex) {
+        BOOST_CHECK_EQUAL(2, ex.index());
+        BOOST_CHECK(std::string(ex.what()).find("Error at element 2: ") == 0);
+        BOOST_CHECK(std::string(ex.what()).find("Intentional") != std::string::npos);
+    }
+    BOOST_CHECK_EQUAL(0, lua_gettop(env));
+    BOOST_CHECK_THROW(lua::for_each(env["fail_on_three"], values), lua::error);
+    BOOST_CHECK_EQUAL(0, lua_gettop(env));
+}
+
+BOOST_AUTO_TEST_CASE(state_pools)
+{
+    int initialized = 0;
+    lua::state_pool pool(2, [&initialized](lua_State* const state) {
+        ++initialized;
+        lua::thread env(state);
+        env["greeting"] = "Hello";
+        std::string script("package.loaded.baseline_module = {}");
+        lua::run_string(env, script);
+    });
+    BOOST_CHECK_EQUAL(2, initialized);
+    BOOST_CHECK_EQUAL(2, pool.size());
+    BOOST_CHECK_EQUAL(2, pool.available());
+
+    lua_State* first = nullptr;
+    {
+        auto lease = pool.acquire();
+        first = lease;
+        BOOST_CHECK_EQUAL(1, pool.available());
+        BOOST_CHECK_EQUAL("Hello", lease.env()["greeting"].get<std::string>());
+
+        std::string script(
+            "greeting = 'Goodbye'\n"
+            "added = 42\n"
+            "print = nil\n"
+            "package.loaded.added_module = {}\n"
+            "package.loaded.baseline_module = nil\n"
+            "setmetatable(_G, { __index = function() return 'missing' end })\n"
+        );
+        lua::run_string(lease.env(), script);
+        lua::push(lease.env(), 1, 2, 3);
+    }
+    BOOST_CHECK_EQUAL(2, pool.available());
+
+    // Is the returned state reset to its baseline, and reused?
+    auto lease = pool.acquire();
+    BOOST_CHECK_EQUAL(first, lease.state());
+    auto& env = lease.env();
+    BOOST_CHECK_EQUAL(0, lua_gettop(env));
+    BOOST_CHECK_EQUAL("Hello", env["greeting"].get<std::string>());
+    BOOST_CHECK(env["added"].type().nil());
+    BOOST_CHECK(env["print"].type().function());
+    BOOST_CHECK(env["undefined"].type().nil());
+    std::string check_loaded(
+        "return package.loaded.added_module == nil and package.loaded.baseline_module ~= nil"
+    );
+    BOOST_CHECK(lua::run_string<bool>(env, check_loaded));
+    lua::clear(env);
+
+    // Does the pool grow when every state is leased?
+    {
+        auto second = pool.acquire();
+        auto third = pool.acquire();
+        BOOST_CHECK(third);
+        BOOST_CHECK_EQUAL(3, initialized);
+        BOOST_CHECK_EQUAL(3, pool.size());
+        BOOST_CHECK_EQUAL(0, pool.available());
+
+        auto moved = std::move(third);
+        BOOST_CHECK(!third);
+        BOOST_CHECK(moved);
+    }
+    BOOST_CHECK_EQUAL(2, pool.available());
+    lease.release();
+    BOOST_CHECK_EQUAL(3, pool.available());
+}
+
+BOOST_AUTO_TEST_CASE(parallel_batches)
+{
+    auto env = lua::create();
+    std::string script(
+        "function double(x) return x * 2 end\n"
+        "function fail_on_even_tens(x) if x % 20 == 0 then error('Intentional') end end\n"
+    );
+    auto bytecode = lua::dump_bytecode(lua::load_string(env, script));
+    lua::clear(env);
+
+    // Can states be seeded from shared bytecode?
+    lua::state_pool pool(3, lua::chunk_initializer(bytecode, "parallel"));
+    BOOST_CHECK_EQUAL(3, pool.size());
+
+    std::vector<int> values;
+    for (int i = 1; i <= 100; ++i) {
+        values.push_back(i);
+    }
+
+    auto doubled = lua::parallel_map<std::vector<int>>(pool, "double", values);
+    BOOST_REQUIRE_EQUAL(100, doubled.size());
+    for (int i = 0; i < 100; ++i) {
+        BOOST_CHECK_EQUAL(2 * values[i], doubled[i]);
+    }
+    BOOST_CHECK_EQUAL(3, pool.available());
+
+    // Are empty and small ranges handled?
+    BOOST_CHECK(lua::parallel_map<std::vector<int>>(pool, "double", std::vector<int>()).empty());
+    auto single = lua::parallel_map<std::vector<int>>(pool, "double", std::vector<int> { 21 });
+    BOOST_REQUIRE_EQUAL(1, single.size());
+    BOOST_CHECK_EQUAL(42, single[0]);
+
+    // Are errors from each slice collected, with positions in the whole range?
+    try {
+        lua::parallel_for(pool, "fail_on_even_tens", values);
+        BOOST_FAIL("lua::parallel_for should have thrown");
+    } catch (lua::parallel_error& ex) {
+        BOOST_REQUIRE_EQUAL(3, ex.errors().size());
+        BOOST_CHECK_EQUAL(19, ex.errors()[0].index());
+        BOOST_CHECK_EQUAL(39, ex.errors()[1].index());
+        BOOST_CHECK_EQUAL(79, ex.errors()[2].index());
+        BOOST_CHECK(std::string(ex.what()).find("Error at element 19: ") == 0);
+        BOOST_CHECK(std::string(ex.what()).find("(and 2 more)") != std::string::npos);
+    }
+    BOOST_CHECK_EQUAL(3, pool.available());
+
+    // Is a missing function reported?
+    BOOST_CHECK_THROW(lua::parallel_for(pool, "undefined", values), lua::error);
+    BOOST_CHECK_EQUAL(3, pool.available());
+}
+
 BOOST_AUTO_TEST_CASE(raw_char)
 {
     auto env = lua::create();
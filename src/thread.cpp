@@ -13,3 +13,11 @@ lua::thread lua::create()
     return env;
 }
 
+
+lua::thread lua::create(std::unique_ptr<lua::allocator> allocator)
+{
+    lua::thread env(lua::newstate(std::move(allocator)));
+    env.set_as_owner();
+    luaL_openlibs(env);
+    return env;
+}
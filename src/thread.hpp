@@ -2,7 +2,9 @@
 #define LUACXX_THREAD_INCLUDED
 
 #include "stack.hpp"
+#include "allocator.hpp"
 #include "global.hpp"
+#include "pinned.hpp"
 
 /*
 
@@ -30,7 +32,7 @@ The biggest is global support: env["foo"] will return a reference to the global
 named foo. This can be chained together to produce env["Device"]["Open"] and
 so forth.
 
-The thread can also own its Lua state, calling lua_close() on it when the
+The thread can also own its Lua state, calling lua::close() on it when the
 thread is being destroyed. Ownership is not enforced, but for quick demos, as
 well as situations with many different states (like in a threading situation),
 the ownership can be useful.
@@ -79,9 +81,10 @@ lua_State* const state() const
 
 /*
 
-=head2 lua::global operator[](std::string)
+=head2 lua::global operator[](std::string), operator[](lua::key)
 
-Returns a reference to the lua::global with the given name.
+Returns a reference to the lua::global with the given name. Using a lua::key
+avoids creating the name's string on every access.
 
 */
 lua::global operator[](const std::string& name)
@@ -89,6 +92,11 @@ lua::global operator[](const std::string& name)
     return lua::global(_state, name);
 }
 
+lua::global operator[](const lua::key& name)
+{
+    return lua::global(_state, name);
+}
+
 thread& operator=(lua::thread& other)
 {
     _state = other._state;
@@ -161,7 +169,7 @@ lua::index operator>>(T& destination)
 ~thread()
 {
     if (_owner) {
-        lua_close(_state);
+        lua::close(_state);
     }
 }
 };
@@ -174,9 +182,15 @@ Conveniently creates a new Lua state with standard libraries that is owned by
 the returned lua::thread; when lua::thread is destroyed, its underlying state
 will be closed. Use clear_owner() to opt-out of this automatic behavior.
 
+=head4 lua::thread create(std::unique_ptr<lua::allocator> allocator);
+
+Creates a new state in the same way, but the state allocates its memory using
+the given lua::allocator, which it owns.
+
 */
 
 lua::thread create();
+lua::thread create(std::unique_ptr<lua::allocator> allocator);
 
 template <>
 struct Push<lua::thread>